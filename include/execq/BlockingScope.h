@@ -0,0 +1,54 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+namespace execq
+{
+    class IExecutionPool;
+    
+    /**
+     * @class BlockingScope
+     * @brief Marks the code that blocks the pool thread, i.e. waits for disk or network I/O.
+     *
+     * @discussion While the pool thread stays inside the scope, the pool may start compensating thread
+     * that executes pool tasks instead of blocked one. Number of such threads is limited
+     * by 'ExecutionPoolOptions::maxCompensatingThreadCount'. Compensating threads stop taking tasks
+     * when blocked threads leave the scope and exit after a while.
+     * @discussion Scope created on non-pool thread or nested into another scope does nothing.
+     */
+    class BlockingScope
+    {
+    public:
+        BlockingScope();
+        ~BlockingScope();
+        
+        BlockingScope(const BlockingScope&) = delete;
+        BlockingScope& operator=(const BlockingScope&) = delete;
+        
+    private:
+        IExecutionPool* m_executionPool = nullptr;
+    };
+}
@@ -0,0 +1,216 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+namespace execq
+{
+    /**
+     * @struct ThreadOptions
+     * @brief Attributes of threads created by execq.
+     * @discussion Attributes that are not supported by the platform are ignored.
+     */
+    struct ThreadOptions
+    {
+        /**
+         * @brief Thread name visible in debuggers and profilers. Empty means unnamed thread.
+         * @discussion On Linux the name is truncated to 15 characters.
+         */
+        std::string name;
+        
+        /**
+         * @brief Stack size of the thread in bytes. Zero means system default.
+         */
+        size_t stackSize = 0;
+        
+        /**
+         * @brief Scheduling policy of the thread (i.e. SCHED_OTHER, SCHED_BATCH, SCHED_FIFO). Negative value means inherited policy.
+         */
+        int schedulingPolicy = -1;
+        
+        /**
+         * @brief Scheduling priority of the thread. Used only if 'schedulingPolicy' is specified.
+         */
+        int schedulingPriority = 0;
+        
+        /**
+         * @brief Nice value of the thread. Zero means inherited value.
+         * @discussion Supported only on Linux, where nice value could be set per thread.
+         */
+        int niceValue = 0;
+        
+        /**
+         * @brief Hook called on the thread after attributes are applied and before it executes any task.
+         * @discussion Use it for custom thread setup: i.e. registering the thread in profiler or tuning attributes not listed here.
+         */
+        std::function<void()> onThreadStart;
+    };
+    
+    
+    /**
+     * @struct ExecutionPoolOptions
+     * @brief Options that tune IExecutionPool behavior.
+     */
+    struct ExecutionPoolOptions
+    {
+        /**
+         * @brief Number of pool threads. Zero means optimal number of threads.
+         * @discussion Optimal number of threads respects CPU affinity and cgroup CPU quota. See 'GetOptimalThreadCount'.
+         */
+        uint32_t threadCount = 0;
+        
+        /**
+         * @brief Time after which idle pool thread exits. Zero means pool threads never exit.
+         * @discussion Pool threads are started lazily when there is work for them and all other threads are busy.
+         * With non-zero timeout the pool becomes elastic: it grows under load up to 'threadCount' threads
+         * and shrinks down to 'minThreadCount' threads when the load goes away.
+         */
+        std::chrono::milliseconds idleThreadTimeout { 0 };
+        
+        /**
+         * @brief Number of pool threads that never exit because of idle timeout.
+         */
+        uint32_t minThreadCount = 0;
+        
+        /**
+         * @brief Starts all threads when the pool is created, so the first tasks do not wait for thread creation.
+         * @discussion Started threads warm up allocator caches and park until there is work for them.
+         * The option is also applied to additional threads of queues and streams created on the pool.
+         */
+        bool startThreadsEagerly = false;
+        
+        /**
+         * @brief Size of stack pre-faulted by eagerly started threads. Zero means no pre-faulting.
+         */
+        size_t prefaultStackSize = 0;
+        
+        /**
+         * @brief CPUs the pool threads are bound to. Empty means no binding.
+         * @discussion The option is also applied to additional threads of queues and streams created on the pool.
+         * Binding is supported only on Linux and ignored on other platforms.
+         */
+        std::vector<uint32_t> cpuAffinity;
+        
+        /**
+         * @brief Enables NUMA-aware mode.
+         * @discussion The pool is split into per-node groups of threads bound to node CPUs (and 'cpuAffinity', if specified).
+         * Each queue/stream is bound to the node of the thread that creates it.
+         * Threads execute tasks of their node and go to other nodes only when their own node has nothing to execute.
+         * If NUMA topology is not available or there is single node, the option is ignored.
+         */
+        bool numaAware = false;
+        
+        /**
+         * @brief Enables 'earliest-deadline-first' mode.
+         * @discussion In this mode pool threads prefer queues whose next object has the nearest deadline
+         * (see IExecutionQueue::pushWithDeadline) instead of taking tasks from all queues 'by turn'.
+         * Queues without deadlines are served 'by turn' when no deadline-bound work is available.
+         */
+        bool earliestDeadlineFirst = false;
+        
+        /**
+         * @brief Maximum number of compensating threads started while pool threads are blocked. Zero disables compensation.
+         * @discussion When the task marks blocking code with BlockingScope, the pool starts one more thread for the time of blocking,
+         * so blocked threads do not decrease the pool parallelism. Compensating thread exits after being idle for a while.
+         */
+        uint32_t maxCompensatingThreadCount = 0;
+        
+        /**
+         * @brief Attributes of pool threads.
+         * @discussion Additional threads of queues and streams use attributes from ExecutionQueueOptions.
+         */
+        ThreadOptions threadOptions;
+    };
+    
+    
+    /**
+     * @struct ExecutionQueueOptions
+     * @brief Options that tune IExecutionQueue and IExecutionStream behavior.
+     */
+    struct ExecutionQueueOptions
+    {
+        /**
+         * @brief Name of the queue/stream used in diagnostics, i.e. in the trace (see 'StartTracing').
+         * @discussion Empty means default name: 'ExecutionQueue' or 'ExecutionStream'.
+         */
+        std::string name;
+        
+        /**
+         * @brief Arbitrary label of the queue/stream, i.e. the component or the tenant it works for.
+         * @discussion Reported in 'ResourceUsage' to group usage of several queues.
+         */
+        std::string tag;
+        
+        /**
+         * @brief Attributes of the queue/stream own thread.
+         * @discussion Each queue and stream has its own thread: it executes tasks if all pool threads are busy
+         * or executes all tasks if the serial queue is created without pool.
+         */
+        ThreadOptions threadOptions;
+        
+        /**
+         * @brief Maximum number of objects the serial queue processes in a row on the same thread.
+         * @discussion Thread that finished the object of serial queue takes the next one itself instead of waking up other thread.
+         * That saves context switch and keeps the data of the queue in the cache, but delays other queues meanwhile.
+         * Default value of 1 disables such batching.
+         */
+        uint32_t serialBatchSize = 1;
+        
+        /**
+         * @brief Maximum time the serial queue holds the thread processing objects in a row. Zero means no time limit.
+         * @discussion When the batch is over, the thread returns to processing other queues 'by turn'.
+         */
+        std::chrono::microseconds serialBatchDuration { 100 };
+        
+        /**
+         * @brief Maximum number of objects waiting in the queue. Zero means unlimited.
+         * @discussion When the queue already has that many waiting objects, 'push' processes new object
+         * on the calling thread ('caller-runs' policy) instead of growing the backlog. Future returned from such 'push' is ready at return.
+         * 'push' never blocks: if the serial queue is being processed on other thread, the object is queued over the limit.
+         */
+        size_t maxPendingObjects = 0;
+        
+        /**
+         * @brief Enables latency histograms of the queue/stream: object wait time and executor run time.
+         * @discussion Histograms are lock-free and cost two clock reads and a few relaxed atomic increments per object.
+         * See 'IExecutionQueue::latencyStats' and 'IExecutionStream::latencyStats'.
+         */
+        bool collectLatencyStats = false;
+        
+        /**
+         * @brief Enables accounting of thread CPU time and wall time consumed by the tasks of the queue/stream.
+         * @discussion Costs two clock reads of each kind per object. See 'IExecutionQueue::resourceUsage',
+         * 'IExecutionStream::resourceUsage' and 'ExecutionPoolStats::providerUsage'.
+         */
+        bool accountResourceUsage = false;
+    };
+}
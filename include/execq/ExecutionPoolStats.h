@@ -0,0 +1,113 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "execq/ResourceUsage.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace execq
+{
+    /**
+     * @brief Runtime statistics of single pool worker.
+     */
+    struct WorkerStats
+    {
+        /**
+         * @brief Number of tasks the worker has taken from the pool.
+         */
+        uint64_t tasksExecuted = 0;
+        
+        /**
+         * @brief Time spent executing tasks and looking for tasks vs time spent waiting for notification.
+         */
+        std::chrono::nanoseconds busyTime { 0 };
+        std::chrono::nanoseconds idleTime { 0 };
+        
+        /**
+         * @brief Number of times the worker has checked for tasks after it had run out of them (i.e. was woken up).
+         * @discussion 'usefulWakeups' counts the ones that found a task.
+         */
+        uint64_t wakeups = 0;
+        uint64_t usefulWakeups = 0;
+        
+        /**
+         * @brief Number of times the worker has found no task at all.
+         */
+        uint64_t emptyScans = 0;
+        
+        /**
+         * @brief The worker has run out of tasks and waits for notification (or is not started yet).
+         */
+        bool parked = true;
+        
+        /**
+         * @brief The worker thread is started and has not exited because of idle timeout.
+         */
+        bool running = false;
+        
+        /**
+         * @brief The worker is running and the pool may give it tasks: it is within the current thread limit
+         * or compensates the blocked thread. Idle time is accounted only while the worker is active.
+         */
+        bool active = false;
+    };
+    
+    /**
+     * @brief Snapshot of pool runtime statistics.
+     * @discussion Counters are collected per worker without synchronization,
+     * so values of different counters may be slightly inconsistent with each other.
+     */
+    struct ExecutionPoolStats
+    {
+        /**
+         * @brief Statistics of all pool worker slots, including compensating ones and ones which threads are not started.
+         */
+        std::vector<WorkerStats> workers;
+        
+        /**
+         * @brief Number of queues, streams and groups attached to the pool.
+         */
+        size_t providerCount = 0;
+        
+        /**
+         * @brief Number of workers that wait for notification.
+         */
+        size_t parkedWorkerCount = 0;
+        
+        /**
+         * @brief Number of workers which threads are running.
+         */
+        size_t runningWorkerCount = 0;
+        
+        /**
+         * @brief Resource usage of attached queues and streams created with 'ExecutionQueueOptions::accountResourceUsage'.
+         */
+        std::vector<ResourceUsage> providerUsage;
+    };
+}
@@ -24,11 +24,30 @@
 
 #pragma once
 
+#include "LatencyStats.h"
+#include "ResourceUsage.h"
+#include "ScheduleHandle.h"
+
 #include <memory>
 #include <future>
+#include <stdexcept>
+#include <chrono>
+#include <functional>
 
 namespace execq
 {
+    /**
+     * @class DeadlineExpiredError
+     * @brief Exception set to the future of the object which deadline expired before processing has started.
+     */
+    class DeadlineExpiredError: public std::runtime_error
+    {
+    public:
+        DeadlineExpiredError()
+        : std::runtime_error("Object deadline expired before processing.")
+        {}
+    };
+    
     template <typename Unused>
     class IExecutionQueue;
     
@@ -66,6 +85,97 @@ namespace execq
         template <typename... Args>
         std::future<R> emplace(Args&&... args);
         
+        /**
+         * @brief Pushes-by-copy an object to be processed on the queue after specified delay.
+         * @discussion Until the delay expires, the object does not occupy the queue and pool threads.
+         * @return Future object to obtain result when the task is done. It also could cancel the object.
+         */
+        ScheduledFuture<R> pushAfter(const std::chrono::steady_clock::duration delay, const T& object);
+        
+        /**
+         * @brief Pushes-by-move an object to be processed on the queue after specified delay.
+         * @discussion Until the delay expires, the object does not occupy the queue and pool threads.
+         * @return Future object to obtain result when the task is done. It also could cancel the object.
+         */
+        ScheduledFuture<R> pushAfter(const std::chrono::steady_clock::duration delay, T&& object);
+        
+        /**
+         * @brief Pushes-by-copy an object to be processed on the queue at specified time.
+         * @discussion Until the time comes, the object does not occupy the queue and pool threads.
+         * @return Future object to obtain result when the task is done. It also could cancel the object.
+         */
+        ScheduledFuture<R> pushAt(const std::chrono::steady_clock::time_point time, const T& object);
+        
+        /**
+         * @brief Pushes-by-move an object to be processed on the queue at specified time.
+         * @discussion Until the time comes, the object does not occupy the queue and pool threads.
+         * @return Future object to obtain result when the task is done. It also could cancel the object.
+         */
+        ScheduledFuture<R> pushAt(const std::chrono::steady_clock::time_point time, T&& object);
+        
+        /**
+         * @brief Periodically pushes copies of the object to be processed on the queue.
+         * @discussion First copy is pushed after one 'period'. Results of processing are discarded.
+         * @discussion Periodic pushing stops when the queue is canceled or destroyed, or when the returned handle is canceled.
+         * @return Handle to stop periodic pushing.
+         */
+        ScheduleHandle pushPeriodic(const std::chrono::steady_clock::duration period, const T& object);
+        
+        /**
+         * @brief Pushes-by-copy an object that must be processed before specified deadline.
+         * @discussion If the deadline expires while the object waits in the queue, the object is dropped without processing
+         * and the future is set with 'DeadlineExpiredError' exception.
+         * @return Future object to obtain result when the task is done.
+         */
+        std::future<R> pushWithDeadline(const std::chrono::steady_clock::time_point deadline, const T& object);
+        
+        /**
+         * @brief Pushes-by-move an object that must be processed before specified deadline.
+         * @discussion If the deadline expires while the object waits in the queue, the object is dropped without processing
+         * and the future is set with 'DeadlineExpiredError' exception.
+         * @return Future object to obtain result when the task is done.
+         */
+        std::future<R> pushWithDeadline(const std::chrono::steady_clock::time_point deadline, T&& object);
+        
+        /**
+         * @brief Processes-by-copy an object on the calling thread if possible, otherwise waits until it is processed on the queue.
+         * @discussion Concurrent queue always processes the object on the calling thread.
+         * Serial queue does that if none of its objects is being processed right now. Objects pushed earlier are processed first,
+         * so serial order is kept. Otherwise the object is pushed into the queue and the calling thread waits for it.
+         * @discussion Never call it from the executor of the same serial queue: that causes deadlock.
+         * @return Result of processing. Exception thrown by the executor is rethrown.
+         */
+        R dispatchSync(const T& object);
+        
+        /**
+         * @brief Processes-by-move an object on the calling thread if possible, otherwise waits until it is processed on the queue.
+         * @discussion See 'dispatchSync(const T&)' for details.
+         * @return Result of processing. Exception thrown by the executor is rethrown.
+         */
+        R dispatchSync(T&& object);
+        
+        /**
+         * @brief Returns number of objects dropped because of expired deadline.
+         */
+        virtual uint64_t expiredCount() const = 0;
+        
+        /**
+         * @brief Returns distributions of object wait time and executor run time.
+         * @discussion Empty if the queue is created without 'ExecutionQueueOptions::collectLatencyStats'.
+         */
+        virtual LatencyStats latencyStats() const = 0;
+        
+        /**
+         * @brief Clears latency distributions, i.e. to measure the next time interval.
+         */
+        virtual void resetLatencyStats() = 0;
+        
+        /**
+         * @brief Returns CPU time and wall time consumed by the queue so far.
+         * @discussion Only name and tag are filled if the queue is created without 'ExecutionQueueOptions::accountResourceUsage'.
+         */
+        virtual ResourceUsage resourceUsage() const = 0;
+        
         /**
          * @brief Makrs all tasks as canceled.
          * @discussion Be aware that new tasks added after 'cancel' call will not be marked as 'canceled'.
@@ -73,25 +183,84 @@ namespace execq
         virtual void cancel() = 0;
         
     private:
-        virtual std::future<R> pushImpl(std::unique_ptr<T> object) = 0;
+        virtual std::future<R> pushImpl(std::unique_ptr<T> object, const std::chrono::steady_clock::time_point deadline) = 0;
+        virtual ScheduledFuture<R> pushAtImpl(const std::chrono::steady_clock::time_point time, std::unique_ptr<T> object) = 0;
+        virtual ScheduleHandle pushPeriodicImpl(const std::chrono::steady_clock::duration period, std::function<std::unique_ptr<T>()> objectFactory) = 0;
+        virtual std::future<R> dispatchSyncImpl(std::unique_ptr<T> object) = 0;
     };
 }
 
 template <typename T, typename R>
 std::future<R> execq::IExecutionQueue<R(T)>::push(const T& object)
 {
-    return pushImpl(std::unique_ptr<T>(new T { object }));
+    return pushImpl(std::unique_ptr<T>(new T { object }), std::chrono::steady_clock::time_point::max());
 }
 
 template <typename T, typename R>
 std::future<R> execq::IExecutionQueue<R(T)>::push(T&& object)
 {
-    return pushImpl(std::unique_ptr<T>(new T { std::move(object) }));
+    return pushImpl(std::unique_ptr<T>(new T { std::move(object) }), std::chrono::steady_clock::time_point::max());
 }
 
 template <typename T, typename R>
 template <typename... Args>
 std::future<R> execq::IExecutionQueue<R(T)>::emplace(Args&&... args)
 {
-    return pushImpl(std::unique_ptr<T>(new T { std::forward<Args>(args)... }));
+    return pushImpl(std::unique_ptr<T>(new T { std::forward<Args>(args)... }), std::chrono::steady_clock::time_point::max());
+}
+
+template <typename T, typename R>
+execq::ScheduledFuture<R> execq::IExecutionQueue<R(T)>::pushAfter(const std::chrono::steady_clock::duration delay, const T& object)
+{
+    return pushAtImpl(std::chrono::steady_clock::now() + delay, std::unique_ptr<T>(new T { object }));
+}
+
+template <typename T, typename R>
+execq::ScheduledFuture<R> execq::IExecutionQueue<R(T)>::pushAfter(const std::chrono::steady_clock::duration delay, T&& object)
+{
+    return pushAtImpl(std::chrono::steady_clock::now() + delay, std::unique_ptr<T>(new T { std::move(object) }));
+}
+
+template <typename T, typename R>
+execq::ScheduledFuture<R> execq::IExecutionQueue<R(T)>::pushAt(const std::chrono::steady_clock::time_point time, const T& object)
+{
+    return pushAtImpl(time, std::unique_ptr<T>(new T { object }));
+}
+
+template <typename T, typename R>
+execq::ScheduledFuture<R> execq::IExecutionQueue<R(T)>::pushAt(const std::chrono::steady_clock::time_point time, T&& object)
+{
+    return pushAtImpl(time, std::unique_ptr<T>(new T { std::move(object) }));
+}
+
+template <typename T, typename R>
+execq::ScheduleHandle execq::IExecutionQueue<R(T)>::pushPeriodic(const std::chrono::steady_clock::duration period, const T& object)
+{
+    return pushPeriodicImpl(period, [object] {
+        return std::unique_ptr<T>(new T { object });
+    });
+}
+
+template <typename T, typename R>
+std::future<R> execq::IExecutionQueue<R(T)>::pushWithDeadline(const std::chrono::steady_clock::time_point deadline, const T& object)
+{
+    return pushImpl(std::unique_ptr<T>(new T { object }), deadline);
+}
+
+template <typename T, typename R>
+std::future<R> execq::IExecutionQueue<R(T)>::pushWithDeadline(const std::chrono::steady_clock::time_point deadline, T&& object)
+{
+    return pushImpl(std::unique_ptr<T>(new T { std::move(object) }), deadline);
+}
+
+template <typename T, typename R>
+R execq::IExecutionQueue<R(T)>::dispatchSync(const T& object)
+{
+    return dispatchSyncImpl(std::unique_ptr<T>(new T { object })).get();
+}
+
+template <typename T, typename R>
+R execq::IExecutionQueue<R(T)>::dispatchSync(T&& object)
+{
+    return dispatchSyncImpl(std::unique_ptr<T>(new T { std::move(object) })).get();
 }
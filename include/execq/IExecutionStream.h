@@ -24,6 +24,9 @@
 
 #pragma once
 
+#include "LatencyStats.h"
+#include "ResourceUsage.h"
+
 #include <memory>
 
 namespace execq
@@ -56,5 +59,22 @@ namespace execq
          * All tasks being executed during stop will normally continue.
          */
         virtual void stop() = 0;
+        
+        /**
+         * @brief Returns distribution of executee run time.
+         * @discussion Empty if the stream is created without 'ExecutionQueueOptions::collectLatencyStats'.
+         */
+        virtual LatencyStats latencyStats() const = 0;
+        
+        /**
+         * @brief Clears latency distributions, i.e. to measure the next time interval.
+         */
+        virtual void resetLatencyStats() = 0;
+        
+        /**
+         * @brief Returns CPU time and wall time consumed by the stream so far.
+         * @discussion Only name and tag are filled if the stream is created without 'ExecutionQueueOptions::accountResourceUsage'.
+         */
+        virtual ResourceUsage resourceUsage() const = 0;
     };
 }
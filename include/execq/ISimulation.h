@@ -0,0 +1,89 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+namespace execq
+{
+    struct SimulationOptions
+    {
+        /**
+         * @brief Virtual time the worker spends on taking each task, i.e. scheduling overhead.
+         */
+        std::chrono::nanoseconds taskOverhead { 0 };
+        
+        /**
+         * @brief Virtual time between notification of parked worker and the moment it starts looking for tasks.
+         */
+        std::chrono::nanoseconds wakeupLatency { 0 };
+    };
+    
+    struct SimulatedWorkerStats
+    {
+        uint64_t tasksExecuted = 0;
+        uint64_t wakeups = 0;
+        std::chrono::nanoseconds busyTime { 0 };
+    };
+    
+    
+    /**
+     * @class ISimulation
+     * @brief Runs pools and queues in deterministic virtual time. Used to compare scheduling policies reproducibly.
+     * @discussion Pools created with 'CreateSimulatedExecutionPool' get simulated workers, as well as queues and streams created on such pools.
+     * Each worker has its own thread, but only one of them runs at a time, handing control over like a coroutine,
+     * so the order of execution depends on virtual time only (ties are resolved in the order of scheduling).
+     * Tasks take no virtual time unless they call 'ConsumeSimulatedTime', i.e. with the duration from a cost model or a recorded trace.
+     * @discussion Delayed and periodic objects and time-limited serial batches still use real clock,
+     * so use 'ExecutionQueueOptions::serialBatchDuration' of zero in simulations. Tasks must not block waiting for other tasks.
+     * The simulation must outlive pools and queues created with it.
+     */
+    class ISimulation
+    {
+    public:
+        virtual ~ISimulation() = default;
+        
+        /**
+         * @brief Calls 'event' on the thread of 'run' at given virtual time, i.e. to push recorded objects into queues.
+         */
+        virtual void schedule(const std::chrono::nanoseconds time, std::function<void()> event) = 0;
+        
+        /**
+         * @brief Processes events until none of them is left and all workers are parked.
+         */
+        virtual void run() = 0;
+        
+        virtual std::chrono::nanoseconds now() const = 0;
+        
+        /**
+         * @brief Returns statistics of alive workers in the order of their creation.
+         */
+        virtual std::vector<SimulatedWorkerStats> workerStats() const = 0;
+    };
+}
@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <exception>
+#include <functional>
+
+namespace execq
+{
+    /**
+     * @class ITaskGroup
+     * @brief High-level interface that provides access to fork-join style of tasks execution.
+     *
+     * @discussion TaskGroup runs arbitrary number of tasks on the pool and allows to wait or cancel all of them as a unit.
+     * Unlike queues, it does not create std::future per task: the group tracks all its tasks with the single counter.
+     */
+    class ITaskGroup
+    {
+    public:
+        virtual ~ITaskGroup() = default;
+        
+        /**
+         * @brief Schedules the task to be executed on the pool as a part of the group.
+         */
+        virtual void run(std::function<void(const std::atomic_bool& isCanceled)> task) = 0;
+        
+        /**
+         * @brief Waits until all tasks of the group are done.
+         * @discussion While waiting, the calling thread executes tasks of the group and other tasks of the pool.
+         * @return Exceptions thrown by the tasks since previous 'wait' call.
+         */
+        virtual std::vector<std::exception_ptr> wait() = 0;
+        
+        /**
+         * @brief Marks all tasks of the group as canceled.
+         * @discussion Be aware that new tasks added after 'cancel' call will not be marked as 'canceled'.
+         */
+        virtual void cancel() = 0;
+    };
+}
@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace execq
+{
+    namespace impl
+    {
+        class LatencyHistogram;
+    }
+    
+    /**
+     * @class LatencyDistribution
+     * @brief Snapshot of latency histogram.
+     * @discussion Values are kept in log-linear buckets with relative precision of about 6%.
+     * Percentiles are reported as upper bound of the bucket (but never above the maximum recorded value).
+     */
+    class LatencyDistribution
+    {
+    public:
+        uint64_t count() const;
+        std::chrono::nanoseconds min() const;
+        std::chrono::nanoseconds max() const;
+        std::chrono::nanoseconds mean() const;
+        
+        /**
+         * @brief Returns the value below which 'percent' (0...100) of recorded values fall. Zero if there are no values.
+         */
+        std::chrono::nanoseconds percentile(const double percent) const;
+        
+    private:
+        friend class impl::LatencyHistogram;
+        
+        std::vector<uint64_t> m_bucketCounts;
+        uint64_t m_count = 0;
+        uint64_t m_sum = 0;
+        uint64_t m_min = 0;
+        uint64_t m_max = 0;
+    };
+    
+    /**
+     * @struct LatencyStats
+     * @brief Latency distributions of queue or stream. Collected only if enabled with 'ExecutionQueueOptions::collectLatencyStats'.
+     */
+    struct LatencyStats
+    {
+        /**
+         * @brief Time from pushing the object (or the time delayed object is due) to the start of its processing.
+         * @discussion Objects processed on the calling thread ('dispatchSync', 'caller-runs') do not wait in the queue
+         * and are not counted here. Streams have no objects to wait for, so the distribution is always empty for them.
+         */
+        LatencyDistribution waitTime;
+        
+        /**
+         * @brief Time the executor runs.
+         */
+        LatencyDistribution executionTime;
+    };
+}
@@ -0,0 +1,73 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace execq
+{
+    /**
+     * @struct LockSiteStats
+     * @brief Contention statistics of internal execq mutexes of one kind (i.e. all queue task mutexes).
+     */
+    struct LockSiteStats
+    {
+        std::string site;
+        
+        uint64_t acquisitions = 0;
+        
+        /**
+         * @brief Number of acquisitions that had to wait because the mutex was held by other thread.
+         */
+        uint64_t contendedAcquisitions = 0;
+        
+        std::chrono::nanoseconds totalWaitTime { 0 };
+        std::chrono::nanoseconds maxWaitTime { 0 };
+        std::chrono::nanoseconds totalHoldTime { 0 };
+        std::chrono::nanoseconds maxHoldTime { 0 };
+    };
+    
+    /**
+     * @brief Returns contention statistics of internal execq mutexes.
+     * @discussion Statistics are collected only if execq is built with EXECQ_MUTEX_PROFILING CMake option.
+     * Otherwise the result is always empty.
+     */
+    std::vector<LockSiteStats> GetLockProfile();
+    
+    /**
+     * @brief Clears collected contention statistics.
+     */
+    void ResetLockProfile();
+    
+    /**
+     * @brief Writes contention statistics as human-readable table.
+     */
+    void DumpLockProfile(std::ostream& output);
+}
@@ -0,0 +1,55 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <ostream>
+#include <string>
+
+namespace execq
+{
+    /**
+     * @brief Writes metrics of all alive pools, queues and streams in Prometheus text exposition format.
+     * @discussion Pools: worker count, parked workers, providers, executed tasks, busy/idle time and utilization.
+     * Queues and streams: pending objects, objects in flight, completed, canceled and expired objects,
+     * wait/execution time quantiles (if created with 'ExecutionQueueOptions::collectLatencyStats')
+     * and CPU/wall time (if created with 'ExecutionQueueOptions::accountResourceUsage').
+     * Rendering takes a snapshot of lock-free counters and briefly locks each queue, so it could be scraped every few seconds.
+     */
+    void ExportPrometheusMetrics(std::ostream& output);
+    
+    /**
+     * @brief Returns metrics in Prometheus text exposition format. See 'ExportPrometheusMetrics'.
+     */
+    std::string GetPrometheusMetrics();
+    
+    /**
+     * @brief Writes metrics in Prometheus text exposition format into the file, i.e. for node_exporter textfile collector.
+     * @discussion The file is replaced atomically: metrics are written into temporary file next to it that is renamed then.
+     * @return false if the file could not be written.
+     */
+    bool WritePrometheusMetrics(const std::string& path);
+}
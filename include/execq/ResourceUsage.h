@@ -0,0 +1,63 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace execq
+{
+    /**
+     * @brief Resources consumed by the queue or stream. Used to attribute pool usage and to enforce quotas.
+     * @discussion Collected only if enabled with 'ExecutionQueueOptions::accountResourceUsage'.
+     * Objects processed on the calling thread (i.e. by 'dispatchSync') are accounted too.
+     */
+    struct ResourceUsage
+    {
+        /**
+         * @brief 'ExecutionQueueOptions::name' and 'ExecutionQueueOptions::tag' of the queue/stream.
+         */
+        std::string name;
+        std::string tag;
+        
+        /**
+         * @brief Number of executed objects (queue) or executees (stream).
+         */
+        uint64_t taskCount = 0;
+        
+        /**
+         * @brief CPU time consumed by threads executing the tasks. Zero on platforms without per-thread CPU clock.
+         */
+        std::chrono::nanoseconds cpuTime { 0 };
+        
+        /**
+         * @brief Wall time of task execution. Much more than 'cpuTime' means the tasks mostly wait (i.e. for I/O or locks).
+         */
+        std::chrono::nanoseconds wallTime { 0 };
+    };
+}
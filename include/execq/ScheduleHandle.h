@@ -0,0 +1,96 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <future>
+#include <functional>
+
+namespace execq
+{
+    /**
+     * @class ScheduleHandle
+     * @brief Handle of the object pushed into the queue with delay or periodically.
+     * @discussion Handle could be copied and could outlive the queue: 'cancel' does nothing then.
+     */
+    class ScheduleHandle
+    {
+    public:
+        ScheduleHandle() = default;
+        explicit ScheduleHandle(std::function<bool()> cancel);
+        
+        /**
+         * @brief Cancels the delayed object or stops periodic pushing. Its timer is removed right away.
+         * @discussion Delayed object is processed immediately as canceled one, like when the queue is destroyed.
+         * If the timer is firing right now, waits until it is done.
+         * @return true if the timer is canceled before it has fired.
+         */
+        bool cancel();
+        
+    private:
+        std::function<bool()> m_cancel;
+    };
+    
+    /**
+     * @class ScheduledFuture
+     * @brief Future of the object pushed into the queue with delay that could also cancel the object.
+     * @discussion Could be used as plain 'std::future'.
+     */
+    template <typename R>
+    class ScheduledFuture: public std::future<R>
+    {
+    public:
+        ScheduledFuture() = default;
+        ScheduledFuture(std::future<R> future, ScheduleHandle handle);
+        
+        /**
+         * @brief See 'ScheduleHandle::cancel'.
+         */
+        bool cancel();
+        
+        const ScheduleHandle& handle() const;
+        
+    private:
+        ScheduleHandle m_handle;
+    };
+}
+
+template <typename R>
+execq::ScheduledFuture<R>::ScheduledFuture(std::future<R> future, ScheduleHandle handle)
+: std::future<R>(std::move(future))
+, m_handle(std::move(handle))
+{}
+
+template <typename R>
+bool execq::ScheduledFuture<R>::cancel()
+{
+    return m_handle.cancel();
+}
+
+template <typename R>
+const execq::ScheduleHandle& execq::ScheduledFuture<R>::handle() const
+{
+    return m_handle;
+}
@@ -0,0 +1,52 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <ostream>
+
+namespace execq
+{
+    /**
+     * @brief Starts recording task execution timeline of all pools, queues, streams and groups.
+     * @discussion Each thread records begin/end events of the tasks it executes (queue name and id) and wakeups of worker threads
+     * into its own ring buffer of 'eventsPerThread' events. When the buffer is full, the oldest events are overwritten.
+     * @discussion Starting tracing again drops all previously recorded events.
+     * While tracing is stopped, recording costs single atomic load per task.
+     */
+    void StartTracing(const size_t eventsPerThread = 16384);
+    
+    /**
+     * @brief Stops recording. Recorded events are kept until the next 'StartTracing'.
+     */
+    void StopTracing();
+    
+    /**
+     * @brief Writes recorded events in Chrome trace JSON format.
+     * @discussion The output could be opened in chrome://tracing or https://ui.perfetto.dev.
+     * Export could be done while tracing is running: events overwritten meanwhile are skipped.
+     */
+    void ExportChromeTrace(std::ostream& output);
+}
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace execq
+{
+    /**
+     * @brief Task (queue object, stream executee or group task) that runs longer than 'WatchdogOptions::longTaskThreshold'.
+     */
+    struct LongRunningTask
+    {
+        /**
+         * @brief 'ExecutionQueueOptions::name' of the queue/stream or 'TaskGroup'.
+         */
+        std::string name;
+        std::chrono::nanoseconds duration { 0 };
+        std::thread::id threadId;
+    };
+    
+    /**
+     * @brief Queue that has pending objects, but none of them is taken for 'WatchdogOptions::starvationThreshold'.
+     */
+    struct StarvedQueue
+    {
+        std::string name;
+        std::string tag;
+        size_t pendingCount = 0;
+        std::chrono::nanoseconds starvedFor { 0 };
+    };
+    
+    struct WatchdogOptions
+    {
+        /**
+         * @brief How often running tasks and queues are checked.
+         */
+        std::chrono::milliseconds checkInterval { 100 };
+        
+        /**
+         * @brief Called once per task that runs longer than the threshold. Null disables the check.
+         */
+        std::chrono::milliseconds longTaskThreshold { 1000 };
+        std::function<void(const LongRunningTask& task)> onLongRunningTask;
+        
+        /**
+         * @brief Called once per period of the queue not being served longer than the threshold. Null disables the check.
+         */
+        std::chrono::milliseconds starvationThreshold { 1000 };
+        std::function<void(const StarvedQueue& queue)> onStarvedQueue;
+    };
+    
+    /**
+     * @brief Starts watchdog thread that reports hung tasks and starved queues of all pools.
+     * @discussion Callbacks are called on the watchdog thread. Starting the watchdog again replaces its options.
+     * Tasks and queue waits that begin before the watchdog is started are not tracked.
+     * While the watchdog is stopped, tracking costs single atomic load per task.
+     */
+    void StartWatchdog(const WatchdogOptions& options);
+    
+    /**
+     * @brief Stops watchdog thread. Must not be called from the watchdog callbacks.
+     */
+    void StopWatchdog();
+}
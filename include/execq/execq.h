@@ -24,8 +24,17 @@
 
 #pragma once
 
+#include "BlockingScope.h"
+#include "ExecutionOptions.h"
+#include "ExecutionPoolStats.h"
 #include "IExecutionQueue.h"
 #include "IExecutionStream.h"
+#include "ISimulation.h"
+#include "ITaskGroup.h"
+#include "LockProfiling.h"
+#include "Metrics.h"
+#include "Tracing.h"
+#include "Watchdog.h"
 
 #include <atomic>
 #include <memory>
@@ -39,8 +48,16 @@ namespace execq
      */
     class IExecutionPool;
     
+    /**
+     * @brief Returns optimal number of threads for the current process.
+     * @discussion The number respects hardware concurrency, CPU affinity mask of the process and cgroup (v1/v2) CPU quota.
+     * It is evaluated each time the function is called.
+     */
+    uint32_t GetOptimalThreadCount();
+    
     /**
      * @brief Creates pool with hardware-optimal number of threads.
+     * @discussion Number of threads is obtained with 'GetOptimalThreadCount' and could be updated with 'ReevaluateThreadCount'.
      * @discussion Usually you want to create single instance of IExecutionPool for multiple IExecutionQueue/IExecutionStream to achive best performance.
      */
     std::shared_ptr<IExecutionPool> CreateExecutionPool();
@@ -51,6 +68,54 @@ namespace execq
      * @param threadCount Number of threads for execution context. If number of threads less than 2, exeption will be raised.
      */
     std::shared_ptr<IExecutionPool> CreateExecutionPool(const uint32_t threadCount);
+    
+    /**
+     * @brief Creates pool with specific options.
+     * @param options Pool options. If number of threads is specified and less than 2, exeption will be raised.
+     */
+    std::shared_ptr<IExecutionPool> CreateExecutionPool(const ExecutionPoolOptions& options);
+    
+    /**
+     * @brief Creates simulation that runs pools in deterministic virtual time (see ISimulation).
+     */
+    std::unique_ptr<ISimulation> CreateSimulation(const SimulationOptions& options = SimulationOptions());
+    
+    /**
+     * @brief Creates pool with workers simulated by 'simulation'. Queues and streams created on the pool get simulated workers too.
+     * @discussion Specify 'ExecutionPoolOptions::threadCount' explicitly: optimal number of threads depends on the machine.
+     * Unlike 'CreateExecutionPool', single-thread pool is allowed.
+     * @param simulation Simulation created with 'CreateSimulation'. Must outlive the pool and its queues.
+     */
+    std::shared_ptr<IExecutionPool> CreateSimulatedExecutionPool(ISimulation& simulation,
+                                                                 const ExecutionPoolOptions& options = ExecutionPoolOptions());
+    
+    /**
+     * @brief Advances virtual time of the current simulated task by 'cost'. Does nothing if called not from the simulated worker.
+     */
+    void ConsumeSimulatedTime(const std::chrono::nanoseconds cost);
+    
+    /**
+     * @brief Updates number of threads used by the pool created with optimal number of threads.
+     * @discussion Call it when CPU quota or affinity of the process changes, i.e. periodically or on container resize.
+     * Pool could use up to number of hardware threads. Pools created with specific number of threads are not affected.
+     */
+    void ReevaluateThreadCount(const std::shared_ptr<IExecutionPool>& executionPool);
+    
+    /**
+     * @brief Returns snapshot of pool runtime statistics: per-worker task counts, busy/idle time, wakeups, etc.
+     * @discussion Statistics are always collected. Collecting costs a few relaxed stores per task on the worker thread.
+     */
+    ExecutionPoolStats GetExecutionPoolStats(const std::shared_ptr<IExecutionPool>& executionPool);
+    
+    /**
+     * @brief Waits until the future becomes ready, executing tasks of the pool on the calling thread meanwhile.
+     * @discussion Use it instead of 'future.wait()' when the task running on the pool waits for the result of other task of the same pool.
+     * It prevents the pool from deadlock when all its threads are waiting for nested tasks and allows fork-join style of execution.
+     * @discussion Never wait this way for the task pushed into the same serial queue from the inside of it: that task will never start.
+     * @param future std::future or std::shared_future bound to the object pushed into any queue of the pool.
+     */
+    template <typename Future>
+    void WaitHelping(const std::shared_ptr<IExecutionPool>& executionPool, const Future& future);
 
     
     
@@ -63,7 +128,8 @@ namespace execq
      */
     template <typename R, typename T>
     std::unique_ptr<IExecutionQueue<R(T)>> CreateConcurrentExecutionQueue(std::shared_ptr<IExecutionPool> executionPool,
-                                                                          std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor);
+                                                                          std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor,
+                                                                          const ExecutionQueueOptions& options = ExecutionQueueOptions());
     
     /**
      * @brief Creates serial queue with specific processing function.
@@ -74,7 +140,8 @@ namespace execq
      */
     template <typename R, typename T>
     std::unique_ptr<IExecutionQueue<R(T)>> CreateSerialExecutionQueue(std::shared_ptr<IExecutionPool> executionPool,
-                                                                      std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor);
+                                                                      std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor,
+                                                                      const ExecutionQueueOptions& options = ExecutionQueueOptions());
     
     /**
      * @brief Creates serial queue with specific processing function.
@@ -83,7 +150,8 @@ namespace execq
      * @discussion This queue can be used to execute long-term tasks like waiting some event etc.
      */
     template <typename R, typename T>
-    std::unique_ptr<IExecutionQueue<R(T)>> CreateSerialExecutionQueue(std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor);
+    std::unique_ptr<IExecutionQueue<R(T)>> CreateSerialExecutionQueue(std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor,
+                                                                      const ExecutionQueueOptions& options = ExecutionQueueOptions());
     
     
     /**
@@ -93,7 +161,16 @@ namespace execq
      * For such purposes use separate thread or serial queue without execution pool.
      */
     std::unique_ptr<IExecutionStream> CreateExecutionStream(std::shared_ptr<IExecutionPool> executionPool,
-                                                            std::function<void(const std::atomic_bool& isCanceled)> executee);
+                                                            std::function<void(const std::atomic_bool& isCanceled)> executee,
+                                                            const ExecutionQueueOptions& options = ExecutionQueueOptions());
+    
+    
+    /**
+     * @brief Creates task group that executes its tasks on the pool.
+     * @discussion Use task group when you need to run a batch of tasks and wait for or cancel all of them at once.
+     * @discussion Group does not have its own thread: if all pool threads are busy, the tasks are executed by the thread that waits the group.
+     */
+    std::unique_ptr<ITaskGroup> CreateTaskGroup(std::shared_ptr<IExecutionPool> executionPool);
     
     
     
@@ -108,7 +185,8 @@ namespace execq
      * For such purposes use separate thread or serial queue without execution pool.
      */
     template <typename R = void>
-    std::unique_ptr<IExecutionQueue<void(QueueTask<R>)>> CreateConcurrentTaskExecutionQueue(std::shared_ptr<IExecutionPool> executionPool);
+    std::unique_ptr<IExecutionQueue<void(QueueTask<R>)>> CreateConcurrentTaskExecutionQueue(std::shared_ptr<IExecutionPool> executionPool,
+                                                                                            const ExecutionQueueOptions& options = ExecutionQueueOptions());
     
     /**
      * @brief Creates serial queue that processes custom tasks.
@@ -118,7 +196,8 @@ namespace execq
      * For such purposes use separate thread or serial queue without execution pool.
      */
     template <typename R = void>
-    std::unique_ptr<IExecutionQueue<void(QueueTask<R>)>> CreateSerialTaskExecutionQueue(std::shared_ptr<IExecutionPool> executionPool);
+    std::unique_ptr<IExecutionQueue<void(QueueTask<R>)>> CreateSerialTaskExecutionQueue(std::shared_ptr<IExecutionPool> executionPool,
+                                                                                        const ExecutionQueueOptions& options = ExecutionQueueOptions());
     
     /**
      * @brief Creates serial queue that processes custom tasks.
@@ -127,7 +206,7 @@ namespace execq
      * @discussion This queue can be used to execute long-term tasks like waiting some event etc.
      */
     template <typename R = void>
-    std::unique_ptr<IExecutionQueue<void(QueueTask<R>)>> CreateSerialTaskExecutionQueue();
+    std::unique_ptr<IExecutionQueue<void(QueueTask<R>)>> CreateSerialTaskExecutionQueue(const ExecutionQueueOptions& options = ExecutionQueueOptions());
     
 }
 
@@ -24,6 +24,8 @@
 
 #pragma once
 
+#include "execq/internal/ProfiledMutex.h"
+
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -45,7 +47,7 @@ namespace execq
             
         private:
             CancelToken m_currentToken = std::make_shared<std::atomic_bool>(false);
-            std::mutex m_mutex;
+            Mutex m_mutex { "CancelTokenProvider::m_mutex" };
         };
     }
 }
@@ -24,14 +24,28 @@
 
 #pragma once
 
+#include "execq/ExecutionOptions.h"
+#include "execq/ExecutionPoolStats.h"
 #include "execq/internal/TaskProviderList.h"
+#include "execq/internal/TimerWheel.h"
 
+#include <mutex>
+#include <chrono>
 #include <atomic>
+#include <limits>
+#include <algorithm>
 #include <memory>
 #include <vector>
+#include <unordered_map>
 
 namespace execq
 {
+    namespace impl
+    {
+        class LocalTaskQueue;
+        class ILocalTaskOwner;
+    }
+    
     class IExecutionPool
     {
     public:
@@ -42,6 +56,31 @@ namespace execq
         
         virtual bool notifyOneWorker() = 0;
         virtual void notifyAllWorkers() = 0;
+        
+        virtual bool executeNextTask() = 0;
+        
+        virtual void setProviderDeadline(impl::ITaskProvider& provider, const std::chrono::steady_clock::time_point deadline) = 0;
+        
+        virtual impl::ThreadWorkerOptions additionalWorkerOptions() const = 0;
+        
+        /**
+         * @brief Returns the factory of pool workers. Queues and streams created on the pool use it for their own workers.
+         */
+        virtual const impl::IThreadWorkerFactory& workerFactory() const = 0;
+        
+        virtual void reevaluateThreadCount() = 0;
+        
+        virtual void beginBlocking() = 0;
+        virtual void endBlocking() = 0;
+        
+        /**
+         * @brief Puts the task into local queue of the current pool thread, so the thread executes it next.
+         * @discussion Must be called only on the pool thread (see details::CurrentThreadExecutionPool).
+         * If no pool thread takes the task for long, it is returned to the owner.
+         */
+        virtual void pushLocalTask(impl::Task task, impl::ILocalTaskOwner& owner) = 0;
+        
+        virtual ExecutionPoolStats stats() const = 0;
     };
     
     namespace impl
@@ -49,7 +88,8 @@ namespace execq
         class ExecutionPool: public IExecutionPool
         {
         public:
-            ExecutionPool(const uint32_t threadCount, const IThreadWorkerFactory& workerFactory);
+            ExecutionPool(const ExecutionPoolOptions& options, const IThreadWorkerFactory& workerFactory);
+            ~ExecutionPool();
             
             virtual void addProvider(ITaskProvider& provider) final;
             virtual void removeProvider(ITaskProvider& provider) final;
@@ -57,18 +97,124 @@ namespace execq
             virtual bool notifyOneWorker() final;
             virtual void notifyAllWorkers() final;
             
+            virtual bool executeNextTask() final;
+            
+            virtual void setProviderDeadline(ITaskProvider& provider, const std::chrono::steady_clock::time_point deadline) final;
+            
+            virtual ThreadWorkerOptions additionalWorkerOptions() const final;
+            
+            virtual const IThreadWorkerFactory& workerFactory() const final;
+            
+            virtual void reevaluateThreadCount() final;
+            
+            virtual void beginBlocking() final;
+            virtual void endBlocking() final;
+            
+            virtual void pushLocalTask(Task task, ILocalTaskOwner& owner) final;
+            
+            virtual ExecutionPoolStats stats() const final;
+            
+        private:
+            class WorkerTaskProvider;
+            
+            /**
+             * @brief Group of workers with its own provider list.
+             * @discussion Usually the pool has single node. In NUMA-aware mode there is a node per NUMA node.
+             * Node workers take tasks from their own list and go to other nodes only when local list has no tasks.
+             */
+            struct Node
+            {
+                explicit Node(const bool earliestDeadlineFirst);
+                
+                TaskProviderList providers;
+                std::vector<std::unique_ptr<IThreadWorker>> workers;
+            };
+            
+            Task nextWorkerTask(WorkerTaskProvider& workerProvider, const bool takeSharedTasks);
+            Task popLocalTask(LocalTaskQueue& localTasks);
+            Task stealLocalTask(const WorkerTaskProvider& thief);
+            void scheduleStealTimer(WorkerTaskProvider& workerProvider);
+            void onStealTimer(WorkerTaskProvider& workerProvider);
+            void reclaimLocalTasks();
+            Task nextNodeTask(const size_t nodeIndex);
+            size_t currentOrFirstNodeIndex() const;
+            size_t currentNodeIndex() const;
+            Node& providerNode(ITaskProvider& provider);
+            
         private:
             std::atomic_bool m_valid { true };
-            TaskProviderList m_providerGroup;
+            const IThreadWorkerFactory& m_workerFactory;
+            ThreadWorkerOptions m_additionalWorkerOptions;
+            
+            const bool m_autoThreadCount;
+            std::atomic<uint32_t> m_threadLimit { 0 };
+            
+            std::vector<std::unique_ptr<Node>> m_nodes;
+            std::vector<size_t> m_cpuNodeIndices;
             
-            std::vector<std::unique_ptr<IThreadWorker>> m_workers;
+            std::atomic<uint32_t> m_blockedThreadCount { 0 };
+            std::vector<std::unique_ptr<IThreadWorker>> m_compensatingWorkers;
+            
+            // Providers of all workers, including compensating ones. Each has local queue of the worker.
+            std::vector<std::unique_ptr<WorkerTaskProvider>> m_workerProviders;
+            std::atomic_size_t m_localTaskCount { 0 };
+            const std::shared_ptr<TimerWheel> m_timerWheel = TimerWheel::shared();
+            const bool m_stealTimerEnabled;
+            
+            std::unordered_map<ITaskProvider*, size_t> m_providerNodeIndices;
+            size_t m_nextProviderNodeIndex = 0;
+            std::mutex m_providerNodesMutex;
         };
         
         
         namespace details
         {
-            bool NotifyWorkers(const std::vector<std::unique_ptr<IThreadWorker>>& workers, const bool single);
+            /**
+             * @brief Returns the pool the current thread belongs to or nullptr if the thread is not a pool thread.
+             */
+            IExecutionPool* CurrentThreadExecutionPool();
+            
+            /**
+             * @brief Returns options of queue/stream own worker: pool-wide options combined with queue thread attributes.
+             */
+            ThreadWorkerOptions AdditionalWorkerOptions(const IExecutionPool* executionPool, const ExecutionQueueOptions& options);
+            
+            /**
+             * @brief Returns factory of queue/stream own worker: the one of the pool or default one if there is no pool.
+             */
+            const IThreadWorkerFactory& AdditionalWorkerFactory(const IExecutionPool* executionPool);
+            
+            bool NotifyWorkers(const std::vector<std::unique_ptr<IThreadWorker>>& workers, const bool single,
+                               const size_t maxCount = std::numeric_limits<size_t>::max());
+            
+            static const std::chrono::microseconds kWaitHelpingMinBackoff { 10 };
+            static const std::chrono::microseconds kWaitHelpingMaxBackoff { 1000 };
+            
+            /**
+             * @brief Calls 'executeTask' until 'isDone' returns true.
+             * @discussion When there is nothing to execute, calls 'waitFor(backoff)' to wait for either the result or new tasks.
+             * Backoff grows exponentially while there are no tasks and resets when one is executed.
+             */
+            template <typename IsDone, typename ExecuteTask, typename WaitFor>
+            void WaitHelpingUntil(const IsDone& isDone, const ExecuteTask& executeTask, const WaitFor& waitFor);
+        }
+    }
+}
+
+template <typename IsDone, typename ExecuteTask, typename WaitFor>
+void execq::impl::details::WaitHelpingUntil(const IsDone& isDone, const ExecuteTask& executeTask, const WaitFor& waitFor)
+{
+    std::chrono::microseconds backoff = kWaitHelpingMinBackoff;
+    while (!isDone())
+    {
+        if (executeTask())
+        {
+            backoff = kWaitHelpingMinBackoff;
+            continue;
         }
+        
+        waitFor(backoff);
+        backoff = std::min(backoff * 2, kWaitHelpingMaxBackoff);
     }
 }
 
@@ -27,7 +27,17 @@
 #include "execq/IExecutionQueue.h"
 #include "execq/internal/CancelTokenProvider.h"
 #include "execq/internal/ExecutionPool.h"
+#include "execq/internal/LatencyHistogram.h"
+#include "execq/internal/LocalTaskQueue.h"
+#include "execq/internal/MetricsRegistry.h"
+#include "execq/internal/ProfiledMutex.h"
+#include "execq/internal/Probes.h"
+#include "execq/internal/TimerWheel.h"
+#include "execq/internal/Tracer.h"
+#include "execq/internal/UsageAccounting.h"
+#include "execq/internal/WatchdogScope.h"
 
+#include <list>
 #include <queue>
 
 namespace execq
@@ -40,51 +50,123 @@ namespace execq
             std::unique_ptr<T> object;
             std::promise<R> promise;
             CancelToken cancelToken;
+            std::chrono::steady_clock::time_point deadline;
+            std::chrono::steady_clock::time_point pushTime;
         };
         
         template <typename R, typename T>
-        class ExecutionQueue: public IExecutionQueue<R(T)>, private ITaskProvider
+        struct DelayedObject
+        {
+            std::unique_ptr<QueuedObject<R, T>> object;
+            TimerWheel::TimerHandle timer;
+            typename std::list<std::shared_ptr<DelayedObject>>::iterator position;
+            bool canceled = false;
+            
+            // used only by periodic objects
+            std::function<std::unique_ptr<T>()> objectFactory;
+            TimerWheel::Clock::time_point nextTime;
+            TimerWheel::Clock::duration period;
+            CancelToken cancelToken;
+        };
+        
+        template <typename R, typename T>
+        class ExecutionQueue: public IExecutionQueue<R(T)>, private ITaskProvider, private IMetricsSource, private ILocalTaskOwner
         {
         public:
             ExecutionQueue(const bool serial, std::shared_ptr<IExecutionPool> executionPool,
                            const IThreadWorkerFactory& workerFactory,
-                           std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor);
+                           std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor,
+                           const ExecutionQueueOptions& options = ExecutionQueueOptions());
             ~ExecutionQueue();
             
         public: // IExecutionQueue
             virtual void cancel() final;
+            virtual uint64_t expiredCount() const final;
+            virtual LatencyStats latencyStats() const final;
+            virtual void resetLatencyStats() final;
+            virtual ResourceUsage resourceUsage() const final;
             
         private: // IExecutionQueue
-            virtual std::future<R> pushImpl(std::unique_ptr<T> object) final;
+            virtual std::future<R> pushImpl(std::unique_ptr<T> object, const std::chrono::steady_clock::time_point deadline) final;
+            virtual ScheduledFuture<R> pushAtImpl(const std::chrono::steady_clock::time_point time, std::unique_ptr<T> object) final;
+            virtual ScheduleHandle pushPeriodicImpl(const std::chrono::steady_clock::duration period, std::function<std::unique_ptr<T>()> objectFactory) final;
+            virtual std::future<R> dispatchSyncImpl(std::unique_ptr<T> object) final;
             
         private: // IThreadWorkerPoolTaskProvider
             virtual Task nextTask() final;
+            virtual const UsageCounters* usageCounters() const final;
+            
+        private: // IMetricsSource
+            virtual ProviderMetrics metrics() final;
+            
+        private: // ILocalTaskOwner
+            virtual void reclaimLocalTask(Task task) final;
             
         private:
-            void execute(T&& object, std::promise<void>& promise, const std::atomic_bool& canceled);
+            void execute(T&& object, std::promise<void>& promise, const std::atomic_bool& canceled,
+                         const std::chrono::steady_clock::time_point pushTime);
             template <typename Y>
-            void execute(T&& object, std::promise<Y>& promise, const std::atomic_bool& canceled);
+            void execute(T&& object, std::promise<Y>& promise, const std::atomic_bool& canceled,
+                         const std::chrono::steady_clock::time_point pushTime);
+            R runExecutor(T&& object, const std::atomic_bool& canceled, const std::chrono::steady_clock::time_point pushTime);
+            void executeQueued(QueuedObject<R, T>& object);
             
+            void pushQueuedObject(std::unique_ptr<QueuedObject<R, T>> object);
             void pushObject(std::unique_ptr<QueuedObject<R, T>> object, bool& alreadyHasTask);
             std::unique_ptr<QueuedObject<R, T>> popObject();
+            std::unique_ptr<QueuedObject<R, T>> popUnexpiredObject();
+            void updateHeadDeadline();
+            
+            ScheduleHandle scheduleDelayedObject(std::shared_ptr<DelayedObject<R, T>> delayedObject, const TimerWheel::Clock::time_point time);
+            bool cancelDelayedObject(const std::shared_ptr<DelayedObject<R, T>>& delayedObject);
+            void onDelayedObjectExpired(const std::shared_ptr<DelayedObject<R, T>>& delayedObject);
+            void flushDelayedObjects();
+            
+            std::future<R> processOnCaller(std::unique_ptr<T> object, const std::chrono::steady_clock::time_point deadline);
+            std::future<R> executeOnCaller(std::unique_ptr<T> object);
+            bool tryClaimSerial();
+            bool hasTooManyPendingObjects();
+            void waitHelping(const std::future<R>& future);
+            
+            bool pushLocalObject(std::unique_ptr<QueuedObject<R, T>>& object);
+            void processSerialBatch();
+            void finishTask();
             
             void notifyWorkers();
-            bool hasTask();
             void waitAllTasks();
             
         private:
             std::atomic_size_t m_taskRunningCount { 0 };
+            std::atomic<uint64_t> m_expiredCount { 0 };
+            ExecutionCounters m_executionCounters;
             
             std::atomic_bool m_hasTask { false };
             std::queue<std::unique_ptr<QueuedObject<R, T>>> m_taskQueue;
-            std::mutex m_taskQueueMutex;
-            std::condition_variable m_taskQueueCondition;
+            std::chrono::steady_clock::time_point m_headDeadline = std::chrono::steady_clock::time_point::max();
+            std::chrono::steady_clock::time_point m_waitingSince = std::chrono::steady_clock::time_point::max();
+            Mutex m_taskQueueMutex { "ExecutionQueue::m_taskQueueMutex" };
+            ConditionVariable m_taskQueueCondition;
+            
+            std::atomic_bool m_hasReclaimedTask { false };
+            std::queue<Task> m_reclaimedTasks;
             
             CancelTokenProvider m_cancelTokenProvider;
             
+            std::list<std::shared_ptr<DelayedObject<R, T>>> m_delayedObjects;
+            bool m_delayedObjectsFlushed = false;
+            Mutex m_delayedObjectsMutex { "ExecutionQueue::m_delayedObjectsMutex" };
+            const std::shared_ptr<TimerWheel> m_timerWheel = TimerWheel::shared();
+            
             const bool m_isSerial = false;
+            const uint32_t m_serialBatchSize = 1;
+            const std::chrono::microseconds m_serialBatchDuration;
+            const size_t m_maxPendingObjects = 0;
             const std::shared_ptr<IExecutionPool> m_executionPool;
             const std::function<R(const std::atomic_bool& isCanceled, T&& object)> m_executor;
+            const std::unique_ptr<LatencyHistograms> m_latencyHistograms;
+            const uint32_t m_traceNameId = 0;
+            UsageCounters m_usageCounters;
+            const bool m_accountResourceUsage = false;
             
             const std::unique_ptr<IThreadWorker> m_additionalWorker;
         };
@@ -94,22 +176,33 @@ namespace execq
 template <typename R, typename T>
 execq::impl::ExecutionQueue<R, T>::ExecutionQueue(const bool serial, std::shared_ptr<IExecutionPool> executionPool,
                                                   const IThreadWorkerFactory& workerFactory,
-                                                  std::function<R(const std::atomic_bool& shouldQuit, T&& object)> executor)
+                                                  std::function<R(const std::atomic_bool& shouldQuit, T&& object)> executor,
+                                                  const ExecutionQueueOptions& options)
 : m_isSerial(serial)
+, m_serialBatchSize(options.serialBatchSize)
+, m_serialBatchDuration(options.serialBatchDuration)
+, m_maxPendingObjects(options.maxPendingObjects)
 , m_executionPool(executionPool)
 , m_executor(std::move(executor))
-, m_additionalWorker(workerFactory.createWorker(*this))
+, m_latencyHistograms(options.collectLatencyStats ? new LatencyHistograms() : nullptr)
+, m_traceNameId(RegisterTraceName(options.name.empty() ? "ExecutionQueue" : options.name))
+, m_usageCounters(options.name.empty() ? "ExecutionQueue" : options.name, options.tag)
+, m_accountResourceUsage(options.accountResourceUsage)
+, m_additionalWorker(workerFactory.createWorker(*this, details::AdditionalWorkerOptions(executionPool.get(), options)))
 {
     if (m_executionPool)
     {
         m_executionPool->addProvider(*this);
     }
+    RegisterMetricsSource(*this);
 }
 
 template <typename R, typename T>
 execq::impl::ExecutionQueue<R, T>::~ExecutionQueue()
 {
+    UnregisterMetricsSource(*this);
     m_cancelTokenProvider.cancel();
+    flushDelayedObjects();
     waitAllTasks();
     if (m_executionPool)
     {
@@ -120,25 +213,59 @@ execq::impl::ExecutionQueue<R, T>::~ExecutionQueue()
 // IExecutionQueue
 
 template <typename R, typename T>
-std::future<R> execq::impl::ExecutionQueue<R, T>::pushImpl(std::unique_ptr<T> object)
+std::future<R> execq::impl::ExecutionQueue<R, T>::pushImpl(std::unique_ptr<T> object, const std::chrono::steady_clock::time_point deadline)
 {
     using QueuedObject = QueuedObject<R, T>;
     
+    // 'caller-runs' policy: serial queue busy on other thread could not run the object here, so it goes over the limit.
+    if (hasTooManyPendingObjects() && (!m_isSerial || tryClaimSerial()))
+    {
+        return executeOnCaller(std::move(object));
+    }
+    
     std::promise<R> promise;
     std::future<R> future = promise.get_future();
     
-    std::unique_ptr<QueuedObject> queuedObject(new QueuedObject { std::move(object), std::move(promise), m_cancelTokenProvider.token() });
+    std::unique_ptr<QueuedObject> queuedObject(new QueuedObject { std::move(object), std::move(promise), m_cancelTokenProvider.token(), deadline,
+                                                                  std::chrono::steady_clock::time_point() });
+    pushQueuedObject(std::move(queuedObject));
     
-    bool alreadyHasTask = false;
-    pushObject(std::move(queuedObject), alreadyHasTask);
+    return future;
+}
+
+template <typename R, typename T>
+std::future<R> execq::impl::ExecutionQueue<R, T>::dispatchSyncImpl(std::unique_ptr<T> object)
+{
+    return processOnCaller(std::move(object), std::chrono::steady_clock::time_point::max());
+}
+
+template <typename R, typename T>
+execq::ScheduledFuture<R> execq::impl::ExecutionQueue<R, T>::pushAtImpl(const std::chrono::steady_clock::time_point time, std::unique_ptr<T> object)
+{
+    using QueuedObject = QueuedObject<R, T>;
     
-    const bool shouldNotify = !m_isSerial || !alreadyHasTask;
-    if (shouldNotify)
-    {
-        notifyWorkers();
-    }
+    std::promise<R> promise;
+    std::future<R> future = promise.get_future();
     
-    return future;
+    std::shared_ptr<DelayedObject<R, T>> delayedObject = std::make_shared<DelayedObject<R, T>>();
+    delayedObject->object.reset(new QueuedObject { std::move(object), std::move(promise), m_cancelTokenProvider.token(),
+                                                   TimerWheel::Clock::time_point::max(), std::chrono::steady_clock::time_point() });
+    
+    return ScheduledFuture<R>(std::move(future), scheduleDelayedObject(std::move(delayedObject), time));
+}
+
+template <typename R, typename T>
+execq::ScheduleHandle execq::impl::ExecutionQueue<R, T>::pushPeriodicImpl(const std::chrono::steady_clock::duration period,
+                                                         std::function<std::unique_ptr<T>()> objectFactory)
+{
+    std::shared_ptr<DelayedObject<R, T>> delayedObject = std::make_shared<DelayedObject<R, T>>();
+    delayedObject->objectFactory = std::move(objectFactory);
+    delayedObject->period = period;
+    delayedObject->nextTime = TimerWheel::Clock::now() + period;
+    delayedObject->cancelToken = m_cancelTokenProvider.token();
+    
+    const TimerWheel::Clock::time_point time = delayedObject->nextTime;
+    return scheduleDelayedObject(std::move(delayedObject), time);
 }
 
 template <typename R, typename T>
@@ -147,48 +274,133 @@ void execq::impl::ExecutionQueue<R, T>::cancel()
     m_cancelTokenProvider.cancelAndRenew();
 }
 
+template <typename R, typename T>
+uint64_t execq::impl::ExecutionQueue<R, T>::expiredCount() const
+{
+    return m_expiredCount;
+}
+
+template <typename R, typename T>
+execq::LatencyStats execq::impl::ExecutionQueue<R, T>::latencyStats() const
+{
+    return m_latencyHistograms ? m_latencyHistograms->snapshot() : LatencyStats();
+}
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::resetLatencyStats()
+{
+    if (m_latencyHistograms)
+    {
+        m_latencyHistograms->reset();
+    }
+}
+
+template <typename R, typename T>
+execq::ResourceUsage execq::impl::ExecutionQueue<R, T>::resourceUsage() const
+{
+    return m_usageCounters.snapshot();
+}
+
 // IThreadWorkerPoolTaskProvider
 
 template <typename R, typename T>
 execq::impl::Task execq::impl::ExecutionQueue<R, T>::nextTask()
 {
-    if (!hasTask())
+    if (m_hasReclaimedTask)
+    {
+        // Reclaimed local task is already counted as running.
+        MutexLockGuard lock(m_taskQueueMutex);
+        if (!m_reclaimedTasks.empty())
+        {
+            Task task = std::move(m_reclaimedTasks.front());
+            m_reclaimedTasks.pop();
+            m_hasReclaimedTask = !m_reclaimedTasks.empty();
+            return task;
+        }
+    }
+    
+    if (!m_hasTask || (m_isSerial && !tryClaimSerial()))
     {
         return Task();
     }
     
-    m_taskRunningCount++;
+    if (!m_isSerial)
+    {
+        m_taskRunningCount++;
+    }
+    
     return Task([&] {
-        std::unique_ptr<QueuedObject<R, T>> object = popObject();
+        std::unique_ptr<QueuedObject<R, T>> object = popUnexpiredObject();
         if (object)
         {
-            execute(std::move(*object->object), object->promise, *object->cancelToken);
+            executeQueued(*object);
         }
         
-        if (--m_taskRunningCount > 0)
+        if (m_isSerial)
         {
-            return;
+            processSerialBatch();
         }
         
-        if (!m_hasTask)
-        {
-            m_taskQueueCondition.notify_all();
-        }
-        else if (m_isSerial) // if there are more tasks and queue is serial, notify workers
-        {
-            notifyWorkers();
-        }
+        finishTask();
     });
 }
 
+template <typename R, typename T>
+const execq::impl::UsageCounters* execq::impl::ExecutionQueue<R, T>::usageCounters() const
+{
+    return m_accountResourceUsage ? &m_usageCounters : nullptr;
+}
+
+// IMetricsSource
+
+template <typename R, typename T>
+execq::impl::ProviderMetrics execq::impl::ExecutionQueue<R, T>::metrics()
+{
+    ProviderMetrics metrics;
+    metrics.kind = m_isSerial ? "serial_queue" : "concurrent_queue";
+    metrics.resourceUsage = m_usageCounters.snapshot();
+    metrics.hasResourceUsage = m_accountResourceUsage;
+    metrics.name = metrics.resourceUsage.name;
+    metrics.tag = metrics.resourceUsage.tag;
+    {
+        MutexLockGuard lock(m_taskQueueMutex);
+        metrics.pendingCount = m_taskQueue.size();
+        metrics.waitingSince = m_waitingSince;
+    }
+    metrics.inFlightCount = m_executionCounters.inFlight.load(std::memory_order_relaxed);
+    metrics.completedCount = m_executionCounters.completed.load(std::memory_order_relaxed);
+    metrics.canceledCount = m_executionCounters.canceled.load(std::memory_order_relaxed);
+    metrics.expiredCount = m_expiredCount;
+    metrics.hasLatencyStats = m_latencyHistograms != nullptr;
+    metrics.latencyStats = latencyStats();
+    
+    return metrics;
+}
+
+// ILocalTaskOwner
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::reclaimLocalTask(Task task)
+{
+    // All pool threads are busy (maybe waiting for this object), so the object is processed on the queue own thread.
+    {
+        MutexLockGuard lock(m_taskQueueMutex);
+        m_reclaimedTasks.push(std::move(task));
+        m_hasReclaimedTask = true;
+    }
+    
+    m_additionalWorker->notifyWorker();
+}
+
 // Private
 
 template <typename R, typename T>
-void execq::impl::ExecutionQueue<R, T>::execute(T&& object, std::promise<void>& promise, const std::atomic_bool& canceled)
+void execq::impl::ExecutionQueue<R, T>::execute(T&& object, std::promise<void>& promise, const std::atomic_bool& canceled,
+                                                const std::chrono::steady_clock::time_point pushTime)
 {
     try
     {
-        m_executor(canceled, std::move(object));
+        runExecutor(std::move(object), canceled, pushTime);
         promise.set_value();
     }
     catch(...)
@@ -204,11 +416,12 @@ void execq::impl::ExecutionQueue<R, T>::execute(T&& object, std::promise<void>&
 
 template <typename R, typename T>
 template <typename Y>
-void execq::impl::ExecutionQueue<R, T>::execute(T&& object, std::promise<Y>& promise, const std::atomic_bool& canceled)
+void execq::impl::ExecutionQueue<R, T>::execute(T&& object, std::promise<Y>& promise, const std::atomic_bool& canceled,
+                                                const std::chrono::steady_clock::time_point pushTime)
 {
     try
     {
-        promise.set_value(m_executor(canceled, std::move(object)));
+        promise.set_value(runExecutor(std::move(object), canceled, pushTime));
     }
     catch(...)
     {
@@ -221,20 +434,72 @@ void execq::impl::ExecutionQueue<R, T>::execute(T&& object, std::promise<Y>& pro
     }
 }
 
+template <typename R, typename T>
+R execq::impl::ExecutionQueue<R, T>::runExecutor(T&& object, const std::atomic_bool& canceled, const std::chrono::steady_clock::time_point pushTime)
+{
+    // Latency and usage are recorded before the promise is set, so it is already counted when the future becomes ready.
+    LatencyScope latencyScope(m_latencyHistograms.get(), pushTime);
+    UsageScope usageScope(m_accountResourceUsage ? &m_usageCounters : nullptr);
+    ExecutionCountScope countScope(m_executionCounters, canceled);
+    WatchdogScope watchdogScope(m_traceNameId);
+    TraceScope traceScope(m_traceNameId, this);
+    ProbeScope probeScope(this, &object);
+    return m_executor(canceled, std::move(object));
+}
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::executeQueued(QueuedObject<R, T>& object)
+{
+    execute(std::move(*object.object), object.promise, *object.cancelToken, object.pushTime);
+}
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::pushQueuedObject(std::unique_ptr<QueuedObject<R, T>> object)
+{
+    if (m_latencyHistograms)
+    {
+        object->pushTime = std::chrono::steady_clock::now();
+    }
+    EXECQ_PROBE2(queue_push, this, object->object.get());
+    
+    if (pushLocalObject(object))
+    {
+        return;
+    }
+    
+    bool alreadyHasTask = false;
+    pushObject(std::move(object), alreadyHasTask);
+    
+    const bool shouldNotify = !m_isSerial || !alreadyHasTask;
+    if (shouldNotify)
+    {
+        notifyWorkers();
+    }
+}
+
 template <typename R, typename T>
 void execq::impl::ExecutionQueue<R, T>::pushObject(std::unique_ptr<QueuedObject<R, T>> object, bool& alreadyHasTask)
 {
-    std::lock_guard<std::mutex> lock(m_taskQueueMutex);
+    MutexLockGuard lock(m_taskQueueMutex);
     
     alreadyHasTask = m_hasTask;
     m_hasTask = true;
     m_taskQueue.push(std::move(object));
+    
+    if (m_taskQueue.size() == 1)
+    {
+        updateHeadDeadline();
+        if (WatchdogEnabled())
+        {
+            m_waitingSince = std::chrono::steady_clock::now();
+        }
+    }
 }
 
 template <typename R, typename T>
 std::unique_ptr<execq::impl::QueuedObject<R, T>> execq::impl::ExecutionQueue<R, T>::popObject()
 {
-    std::lock_guard<std::mutex> lock(m_taskQueueMutex);
+    MutexLockGuard lock(m_taskQueueMutex);
     if (m_taskQueue.empty())
     {
         return nullptr;
@@ -244,24 +509,359 @@ std::unique_ptr<execq::impl::QueuedObject<R, T>> execq::impl::ExecutionQueue<R,
     m_taskQueue.pop();
     
     m_hasTask = !m_taskQueue.empty();
+    updateHeadDeadline();
+    
+    // Remaining objects wait to be served from now on.
+    m_waitingSince = m_hasTask && WatchdogEnabled() ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point::max();
     
     return object;
 }
 
 template <typename R, typename T>
-bool execq::impl::ExecutionQueue<R, T>::hasTask()
+execq::ScheduleHandle execq::impl::ExecutionQueue<R, T>::scheduleDelayedObject(std::shared_ptr<DelayedObject<R, T>> delayedObject,
+                                                                               const TimerWheel::Clock::time_point time)
 {
-    if (!m_hasTask)
+    {
+        MutexLockGuard lock(m_delayedObjectsMutex);
+        delayedObject->position = m_delayedObjects.insert(m_delayedObjects.end(), delayedObject);
+        delayedObject->timer = m_timerWheel->schedule(time, [this, delayedObject] {
+            onDelayedObjectExpired(delayedObject);
+        });
+    }
+    
+    // Object is released when it is done or when the queue is destroyed, so the handle that outlives it does nothing.
+    std::weak_ptr<DelayedObject<R, T>> weakDelayedObject = delayedObject;
+    return ScheduleHandle([this, weakDelayedObject] {
+        const std::shared_ptr<DelayedObject<R, T>> delayedObject = weakDelayedObject.lock();
+        return delayedObject && cancelDelayedObject(delayedObject);
+    });
+}
+
+template <typename R, typename T>
+bool execq::impl::ExecutionQueue<R, T>::cancelDelayedObject(const std::shared_ptr<DelayedObject<R, T>>& delayedObject)
+{
+    TimerWheel::TimerHandle timer;
+    {
+        MutexLockGuard lock(m_delayedObjectsMutex);
+        if (delayedObject->canceled)
+        {
+            return false;
+        }
+        
+        // Periodic object is not rescheduled anymore, even if its timer is firing right now.
+        delayedObject->canceled = true;
+        timer = delayedObject->timer;
+    }
+    
+    if (!m_timerWheel->cancel(timer))
     {
         return false;
     }
     
+    std::unique_ptr<QueuedObject<R, T>> object;
+    {
+        MutexLockGuard lock(m_delayedObjectsMutex);
+        m_delayedObjects.erase(delayedObject->position);
+        object = std::move(delayedObject->object);
+    }
+    
+    if (object)
+    {
+        object->cancelToken = std::make_shared<std::atomic_bool>(true);
+        pushQueuedObject(std::move(object));
+    }
+    
+    return true;
+}
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::onDelayedObjectExpired(const std::shared_ptr<DelayedObject<R, T>>& delayedObject)
+{
+    const bool periodic = static_cast<bool>(delayedObject->objectFactory);
+    
+    std::unique_ptr<QueuedObject<R, T>> object;
+    bool produceObject = false;
+    {
+        MutexLockGuard lock(m_delayedObjectsMutex);
+        if (!periodic)
+        {
+            object = std::move(delayedObject->object);
+        }
+        else
+        {
+            produceObject = !m_delayedObjectsFlushed && !delayedObject->canceled && !*delayedObject->cancelToken;
+        }
+    }
+    
+    // Factory is the client code running on the shared timer thread: it is called without the lock, so it may use the queue,
+    // and its failure skips only this tick.
+    if (produceObject)
+    {
+        std::unique_ptr<T> producedObject;
+        try
+        {
+            producedObject = delayedObject->objectFactory();
+        }
+        catch (...)
+        {}
+        
+        if (producedObject)
+        {
+            object.reset(new QueuedObject<R, T> { std::move(producedObject), std::promise<R>(), delayedObject->cancelToken,
+                                                  TimerWheel::Clock::time_point::max(), std::chrono::steady_clock::time_point() });
+        }
+    }
+    
+    if (object)
+    {
+        pushQueuedObject(std::move(object));
+    }
+    
+    // Object stays in the list until the callback is done, so the queue waits for it when destroyed.
+    MutexLockGuard lock(m_delayedObjectsMutex);
+    if (periodic && !m_delayedObjectsFlushed && !delayedObject->canceled && !*delayedObject->cancelToken)
+    {
+        // Next time is counted from the previous one, so the period does not drift.
+        delayedObject->nextTime += delayedObject->period;
+        delayedObject->timer = m_timerWheel->schedule(delayedObject->nextTime, [this, delayedObject] {
+            onDelayedObjectExpired(delayedObject);
+        });
+    }
+    else
+    {
+        m_delayedObjects.erase(delayedObject->position);
+    }
+}
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::flushDelayedObjects()
+{
+    std::list<std::shared_ptr<DelayedObject<R, T>>> delayedObjects;
+    {
+        MutexLockGuard lock(m_delayedObjectsMutex);
+        m_delayedObjectsFlushed = true;
+        delayedObjects = m_delayedObjects;
+    }
+    
+    // Objects which timers are canceled are pushed immediately to be processed as canceled ones.
+    // If the timer is firing right now, 'cancel' waits until its callback is done.
+    for (const auto& delayedObject : delayedObjects)
+    {
+        if (!m_timerWheel->cancel(delayedObject->timer))
+        {
+            continue;
+        }
+        
+        std::unique_ptr<QueuedObject<R, T>> object;
+        {
+            MutexLockGuard lock(m_delayedObjectsMutex);
+            m_delayedObjects.erase(delayedObject->position);
+            object = std::move(delayedObject->object);
+        }
+        
+        if (object)
+        {
+            pushQueuedObject(std::move(object));
+        }
+    }
+}
+
+template <typename R, typename T>
+std::unique_ptr<execq::impl::QueuedObject<R, T>> execq::impl::ExecutionQueue<R, T>::popUnexpiredObject()
+{
+    // Objects with expired deadline are dropped without processing to not waste time on useless work.
+    while (true)
+    {
+        std::unique_ptr<QueuedObject<R, T>> object = popObject();
+        if (!object || object->deadline == std::chrono::steady_clock::time_point::max() || object->deadline > std::chrono::steady_clock::now())
+        {
+            return object;
+        }
+        
+        m_expiredCount++;
+        try
+        {
+            object->promise.set_exception(std::make_exception_ptr(DeadlineExpiredError()));
+        }
+        catch(...)
+        {} // set_exception() may throw too
+    }
+}
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::updateHeadDeadline()
+{
+    // Pool is notified only when the deadline changes, so queues without deadlines never bother it.
+    const std::chrono::steady_clock::time_point headDeadline = m_taskQueue.empty()
+    ? std::chrono::steady_clock::time_point::max()
+    : m_taskQueue.front()->deadline;
+    
+    if (headDeadline != m_headDeadline)
+    {
+        m_headDeadline = headDeadline;
+        if (m_executionPool)
+        {
+            m_executionPool->setProviderDeadline(*this, headDeadline);
+        }
+    }
+}
+
+template <typename R, typename T>
+std::future<R> execq::impl::ExecutionQueue<R, T>::processOnCaller(std::unique_ptr<T> object, const std::chrono::steady_clock::time_point deadline)
+{
+    if (m_isSerial && !tryClaimSerial())
+    {
+        // Objects are being processed on other thread: pass the object through the queue to keep serial order.
+        std::promise<R> promise;
+        std::future<R> future = promise.get_future();
+        pushQueuedObject(std::unique_ptr<QueuedObject<R, T>>(new QueuedObject<R, T> { std::move(object), std::move(promise),
+                                                                                      m_cancelTokenProvider.token(), deadline,
+                                                                                      std::chrono::steady_clock::time_point() }));
+        waitHelping(future);
+        return future;
+    }
+    
+    return executeOnCaller(std::move(object));
+}
+
+template <typename R, typename T>
+std::future<R> execq::impl::ExecutionQueue<R, T>::executeOnCaller(std::unique_ptr<T> object)
+{
+    // Serial queue must be already claimed by the calling thread.
+    std::promise<R> promise;
+    std::future<R> future = promise.get_future();
+    const CancelToken cancelToken = m_cancelTokenProvider.token();
+    
     if (!m_isSerial)
     {
-        return true;
+        execute(std::move(*object), promise, *cancelToken, std::chrono::steady_clock::time_point());
+        return future;
+    }
+    
+    // Objects pushed before must be processed first. Ones pushed meanwhile are processed after this object.
+    size_t pendingCount = 0;
+    {
+        MutexLockGuard lock(m_taskQueueMutex);
+        pendingCount = m_taskQueue.size();
+    }
+    
+    for (size_t i = 0; i < pendingCount; i++)
+    {
+        std::unique_ptr<QueuedObject<R, T>> pendingObject = popUnexpiredObject();
+        if (!pendingObject)
+        {
+            break;
+        }
+        
+        executeQueued(*pendingObject);
+    }
+    
+    execute(std::move(*object), promise, *cancelToken, std::chrono::steady_clock::time_point());
+    finishTask();
+    
+    return future;
+}
+
+template <typename R, typename T>
+bool execq::impl::ExecutionQueue<R, T>::tryClaimSerial()
+{
+    // Serial queue is processed by single thread at a time: the one that turned running count from zero.
+    size_t runningCount = 0;
+    return m_taskRunningCount.compare_exchange_strong(runningCount, 1);
+}
+
+template <typename R, typename T>
+bool execq::impl::ExecutionQueue<R, T>::hasTooManyPendingObjects()
+{
+    if (!m_maxPendingObjects)
+    {
+        return false;
+    }
+    
+    MutexLockGuard lock(m_taskQueueMutex);
+    return m_taskQueue.size() >= m_maxPendingObjects;
+}
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::waitHelping(const std::future<R>& future)
+{
+    // Pool thread waiting for the object executes other pool tasks meanwhile, so the pool does not lose the thread.
+    const bool helpPool = m_executionPool && details::CurrentThreadExecutionPool() == m_executionPool.get();
+    if (!helpPool)
+    {
+        future.wait();
+        return;
+    }
+    
+    details::WaitHelpingUntil([&] {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }, [&] {
+        return m_executionPool->executeNextTask();
+    }, [&] (const std::chrono::microseconds backoff) {
+        future.wait_for(backoff);
+    });
+}
+
+template <typename R, typename T>
+bool execq::impl::ExecutionQueue<R, T>::pushLocalObject(std::unique_ptr<QueuedObject<R, T>>& object)
+{
+    // Object pushed into concurrent queue from the pool thread is likely to process data that thread has just produced.
+    // It bypasses the queue and goes to the local queue of the thread to be executed on it next.
+    const bool local = !m_isSerial && m_executionPool && details::CurrentThreadExecutionPool() == m_executionPool.get()
+    && object->deadline == std::chrono::steady_clock::time_point::max();
+    if (!local)
+    {
+        return false;
     }
     
-    return !m_taskRunningCount;
+    m_taskRunningCount++;
+    std::shared_ptr<QueuedObject<R, T>> localObject(std::move(object));
+    m_executionPool->pushLocalTask(Task([this, localObject] {
+        executeQueued(*localObject);
+        finishTask();
+    }), *this);
+    
+    return true;
+}
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::processSerialBatch()
+{
+    // Serial queue task is still 'running', so no other thread takes objects of the queue meanwhile.
+    const std::chrono::steady_clock::time_point batchEnd = std::chrono::steady_clock::now() + m_serialBatchDuration;
+    for (uint32_t i = 1; i < m_serialBatchSize && m_hasTask; i++)
+    {
+        if (m_serialBatchDuration.count() && std::chrono::steady_clock::now() >= batchEnd)
+        {
+            break;
+        }
+        
+        std::unique_ptr<QueuedObject<R, T>> object = popUnexpiredObject();
+        if (!object)
+        {
+            break;
+        }
+        
+        executeQueued(*object);
+    }
+}
+
+template <typename R, typename T>
+void execq::impl::ExecutionQueue<R, T>::finishTask()
+{
+    if (--m_taskRunningCount > 0)
+    {
+        return;
+    }
+    
+    if (!m_hasTask)
+    {
+        m_taskQueueCondition.notify_all();
+    }
+    else if (m_isSerial) // if there are more tasks and queue is serial, notify workers
+    {
+        notifyWorkers();
+    }
 }
 
 template <typename R, typename T>
@@ -276,9 +876,27 @@ void execq::impl::ExecutionQueue<R, T>::notifyWorkers()
 template <typename R, typename T>
 void execq::impl::ExecutionQueue<R, T>::waitAllTasks()
 {
-    std::unique_lock<std::mutex> lock(m_taskQueueMutex);
-    while (m_taskRunningCount > 0 || !m_taskQueue.empty())
+    // Queue destroyed on the pool thread could have tasks in the local queue of this thread: execute them instead of waiting forever.
+    const bool helpPool = m_executionPool && details::CurrentThreadExecutionPool() == m_executionPool.get();
+    
+    if (!helpPool)
     {
-        m_taskQueueCondition.wait(lock);
+        MutexUniqueLock lock(m_taskQueueMutex);
+        m_taskQueueCondition.wait(lock, [&] {
+            return m_taskRunningCount <= 0 && m_taskQueue.empty();
+        });
+        return;
     }
+    
+    details::WaitHelpingUntil([&] {
+        MutexLockGuard lock(m_taskQueueMutex);
+        return m_taskRunningCount <= 0 && m_taskQueue.empty();
+    }, [&] {
+        return m_executionPool->executeNextTask();
+    }, [&] (const std::chrono::microseconds backoff) {
+        MutexUniqueLock lock(m_taskQueueMutex);
+        m_taskQueueCondition.wait_for(lock, backoff, [&] {
+            return m_taskRunningCount <= 0 && m_taskQueue.empty();
+        });
+    });
 }
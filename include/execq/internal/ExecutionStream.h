@@ -26,6 +26,9 @@
 
 #include "execq/IExecutionStream.h"
 #include "execq/internal/ExecutionPool.h"
+#include "execq/internal/LatencyHistogram.h"
+#include "execq/internal/MetricsRegistry.h"
+#include "execq/internal/UsageAccounting.h"
 
 #include <mutex>
 #include <thread>
@@ -36,20 +39,28 @@ namespace execq
 {
     namespace impl
     {
-        class ExecutionStream: public IExecutionStream, private ITaskProvider
+        class ExecutionStream: public IExecutionStream, private ITaskProvider, private IMetricsSource
         {
         public:
             ExecutionStream(std::shared_ptr<IExecutionPool> executionPool,
                             const IThreadWorkerFactory& workerFactory,
-                            std::function<void(const std::atomic_bool& isCanceled)> executee);
+                            std::function<void(const std::atomic_bool& isCanceled)> executee,
+                            const ExecutionQueueOptions& options = ExecutionQueueOptions());
             ~ExecutionStream();
             
         public: // IExecutionStream
             virtual void start() final;
             virtual void stop() final;
+            virtual LatencyStats latencyStats() const final;
+            virtual void resetLatencyStats() final;
+            virtual ResourceUsage resourceUsage() const final;
             
         private: // ITaskProvider
             virtual Task nextTask() final;
+            virtual const UsageCounters* usageCounters() const final;
+            
+        private: // IMetricsSource
+            virtual ProviderMetrics metrics() final;
             
         private:
             void waitPendingTasks();
@@ -58,11 +69,16 @@ namespace execq
             std::atomic_bool m_stopped { true };
             
             std::atomic_size_t m_tasksRunningCount { 0 };
+            ExecutionCounters m_executionCounters;
             std::mutex m_taskCompleteMutex;
             std::condition_variable m_taskCompleteCondition;
             
             const std::shared_ptr<IExecutionPool> m_executionPool;
             const std::function<void(const std::atomic_bool& shouldQuit)> m_executee;
+            const std::unique_ptr<LatencyHistograms> m_latencyHistograms;
+            const uint32_t m_traceNameId = 0;
+            UsageCounters m_usageCounters;
+            const bool m_accountResourceUsage = false;
             
             const std::unique_ptr<IThreadWorker> m_additionalWorker;
         };
@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "execq/LatencyStats.h"
+
+#include <atomic>
+#include <memory>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @class LatencyHistogram
+         * @brief Lock-free log-linear (HDR-like) histogram of durations.
+         * @discussion Recording is a few relaxed atomic increments, so it could be left on in production.
+         * Reset concurrent with recording may lose or keep some values recorded meanwhile.
+         */
+        class LatencyHistogram
+        {
+        public:
+            LatencyHistogram();
+            
+            void record(const std::chrono::nanoseconds value);
+            LatencyDistribution snapshot() const;
+            void reset();
+            
+        private:
+            std::unique_ptr<std::atomic<uint64_t>[]> m_bucketCounts;
+            std::atomic<uint64_t> m_count { 0 };
+            std::atomic<uint64_t> m_sum { 0 };
+            std::atomic<uint64_t> m_min { 0 };
+            std::atomic<uint64_t> m_max { 0 };
+        };
+        
+        
+        struct LatencyHistograms
+        {
+            LatencyHistogram waitTime;
+            LatencyHistogram executionTime;
+            
+            LatencyStats snapshot() const;
+            void reset();
+        };
+        
+        
+        /**
+         * @class LatencyScope
+         * @brief Records wait time when created and execution time when destroyed. Does nothing if histograms are null.
+         * @discussion Zero push time means the work was not queued, so its wait time is not recorded.
+         * @discussion Execution time of the nested scope (task executed while the outer one waits) is excluded from the outer scope.
+         */
+        class LatencyScope
+        {
+        public:
+            LatencyScope(LatencyHistograms* histograms, const std::chrono::steady_clock::time_point pushTime);
+            ~LatencyScope();
+            
+            LatencyScope(const LatencyScope&) = delete;
+            LatencyScope& operator=(const LatencyScope&) = delete;
+            
+        private:
+            LatencyHistograms* const m_histograms;
+            LatencyScope* m_parent = nullptr;
+            std::chrono::steady_clock::time_point m_startTime;
+            std::chrono::steady_clock::duration m_nestedTime { 0 };
+        };
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "execq/internal/ProfiledMutex.h"
+#include "execq/internal/ThreadWorker.h"
+
+#include <deque>
+#include <mutex>
+#include <atomic>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @class ILocalTaskOwner
+         * @brief Provider that pushes local tasks, i.e. the queue. Takes back the tasks no pool thread could execute.
+         */
+        class ILocalTaskOwner
+        {
+        public:
+            virtual ~ILocalTaskOwner() = default;
+            
+            /**
+             * @brief Called when all pool threads are busy for long (maybe waiting for this very task).
+             * @discussion The owner must execute the task on its own thread.
+             */
+            virtual void reclaimLocalTask(Task task) = 0;
+        };
+        
+        struct LocalTask
+        {
+            Task task;
+            ILocalTaskOwner* owner;
+        };
+        
+        /**
+         * @class LocalTaskQueue
+         * @brief Buffer of tasks spawned on the pool worker thread.
+         * @discussion The newest task is kept in the 'LIFO slot' and is executed by the owner right after the current one,
+         * while its data is still hot in the cache. Older tasks are moved into FIFO queue, where other workers steal them from.
+         */
+        class LocalTaskQueue
+        {
+        public:
+            /**
+             * @brief Puts the task into the LIFO slot.
+             * @return true if the previous task was moved from the slot to the queue and could be stolen.
+             */
+            bool push(Task&& task, ILocalTaskOwner& owner);
+            
+            /**
+             * @brief Returns the task for the owner: from the slot first, then the oldest one from the queue.
+             */
+            Task pop();
+            
+            /**
+             * @brief Returns the oldest task for other worker. The slot is stolen only if the queue is empty.
+             */
+            LocalTask steal();
+            
+            bool empty() const;
+            
+        private:
+            LocalTask m_slot { Task(), nullptr };
+            std::deque<LocalTask> m_tasks;
+            std::atomic_size_t m_size { 0 };
+            Mutex m_mutex { "LocalTaskQueue::m_mutex" };
+        };
+    }
+}
@@ -0,0 +1,121 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include "execq/LatencyStats.h"
+#include "execq/ResourceUsage.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace execq
+{
+    class IExecutionPool;
+    
+    namespace impl
+    {
+        /**
+         * @brief Snapshot of queue or stream metrics.
+         */
+        struct ProviderMetrics
+        {
+            uint64_t id = 0;
+            const char* kind = "";
+            std::string name;
+            std::string tag;
+            
+            uint64_t pendingCount = 0;
+            uint64_t inFlightCount = 0;
+            uint64_t completedCount = 0;
+            uint64_t canceledCount = 0;
+            uint64_t expiredCount = 0;
+            
+            /**
+             * @brief Time since the queue has pending objects but none of them is taken. Tracked only while watchdog is enabled.
+             */
+            std::chrono::steady_clock::time_point waitingSince = std::chrono::steady_clock::time_point::max();
+            
+            bool hasLatencyStats = false;
+            LatencyStats latencyStats;
+            
+            bool hasResourceUsage = false;
+            ResourceUsage resourceUsage;
+        };
+        
+        
+        class IMetricsSource
+        {
+        public:
+            virtual ~IMetricsSource() = default;
+            
+            virtual ProviderMetrics metrics() = 0;
+        };
+        
+        
+        /**
+         * @brief Pools and metrics sources are registered for their whole lifetime to be found by the exporter.
+         * @discussion Unregistering waits for the export that is in progress, so the object could be destroyed right after it.
+         */
+        void RegisterMetricsPool(const IExecutionPool& pool);
+        void UnregisterMetricsPool(const IExecutionPool& pool);
+        void RegisterMetricsSource(IMetricsSource& source);
+        void UnregisterMetricsSource(IMetricsSource& source);
+        
+        /**
+         * @brief Returns metrics of all registered sources ordered by registration.
+         */
+        std::vector<ProviderMetrics> CollectProviderMetrics();
+        
+        
+        /**
+         * @brief Lock-free counters of processed objects.
+         */
+        struct ExecutionCounters
+        {
+            std::atomic<uint64_t> inFlight { 0 };
+            std::atomic<uint64_t> completed { 0 };
+            std::atomic<uint64_t> canceled { 0 };
+        };
+        
+        
+        /**
+         * @class ExecutionCountScope
+         * @brief Counts the object as in flight while alive and as completed when destroyed, even if the executor throws.
+         */
+        class ExecutionCountScope
+        {
+        public:
+            ExecutionCountScope(ExecutionCounters& counters, const bool canceled);
+            ~ExecutionCountScope();
+            
+        private:
+            ExecutionCounters& m_counters;
+        };
+    }
+}
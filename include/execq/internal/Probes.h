@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+/**
+ * @discussion USDT (SystemTap/DTrace-style) static probes of execq, provider 'execq'.
+ * Probes are compiled in only with EXECQ_USDT_PROBES CMake option and available <sys/sdt.h>.
+ * Not attached probe is a single 'nop' instruction. Probes:
+ *   queue_push(queue, object)      object is enqueued into the queue
+ *   object_start(queue, object)    executor starts processing the object
+ *   object_finish(queue, object)   executor finished processing the object
+ *   task_start(worker)             worker thread starts the task
+ *   task_finish(worker)            worker thread finished the task
+ *   worker_park(worker)            worker thread has no tasks and goes to sleep
+ *   worker_unpark(worker)          worker thread woke up
+ *   provider_add(pool, provider)   queue/stream/group is attached to the pool
+ *   provider_remove(pool, provider)
+ *   cancel(tokenProvider)          tasks of the queue/group are canceled
+ * Object is identified by its address, which stays the same from push to processing.
+ */
+
+#if defined(EXECQ_USDT_PROBES) && defined(__has_include)
+#   if __has_include(<sys/sdt.h>)
+#       include <sys/sdt.h>
+#       define EXECQ_PROBES_ENABLED 1
+#   endif
+#endif
+
+#ifdef EXECQ_PROBES_ENABLED
+#   define EXECQ_PROBE1(name, arg1) DTRACE_PROBE1(execq, name, arg1)
+#   define EXECQ_PROBE2(name, arg1, arg2) DTRACE_PROBE2(execq, name, arg1, arg2)
+#else
+#   define EXECQ_PROBE1(name, arg1) do {} while (0)
+#   define EXECQ_PROBE2(name, arg1, arg2) do {} while (0)
+#endif
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @class ProbeScope
+         * @brief Fires 'object_start' probe when created and 'object_finish' when destroyed.
+         */
+        class ProbeScope
+        {
+        public:
+#ifdef EXECQ_PROBES_ENABLED
+            ProbeScope(const void* queue, const void* object)
+            : m_queue(queue)
+            , m_object(object)
+            {
+                EXECQ_PROBE2(object_start, m_queue, m_object);
+            }
+            
+            ~ProbeScope()
+            {
+                EXECQ_PROBE2(object_finish, m_queue, m_object);
+            }
+            
+        private:
+            const void* const m_queue;
+            const void* const m_object;
+#else
+            ProbeScope(const void*, const void*)
+            {}
+#endif
+        };
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @brief Counters of all mutexes of the same lock site.
+         */
+        struct LockSiteCounters
+        {
+            std::atomic<uint64_t> acquisitions { 0 };
+            std::atomic<uint64_t> contendedAcquisitions { 0 };
+            std::atomic<uint64_t> totalWaitTime { 0 };
+            std::atomic<uint64_t> maxWaitTime { 0 };
+            std::atomic<uint64_t> totalHoldTime { 0 };
+            std::atomic<uint64_t> maxHoldTime { 0 };
+        };
+        
+        /**
+         * @brief Returns counters of the lock site with given name. Counters live as long as the process.
+         */
+        LockSiteCounters& GetLockSiteCounters(const char* site);
+        
+        
+        /**
+         * @class ProfiledMutex
+         * @brief Mutex that records acquisitions, contention, wait and hold time into counters of its lock site.
+         */
+        class ProfiledMutex
+        {
+        public:
+            explicit ProfiledMutex(const char* site);
+            
+            ProfiledMutex(const ProfiledMutex&) = delete;
+            ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+            
+            void lock();
+            bool try_lock();
+            void unlock();
+            
+        private:
+            std::mutex m_mutex;
+            LockSiteCounters& m_counters;
+            std::chrono::steady_clock::time_point m_lockTime;
+        };
+        
+        
+        /**
+         * @discussion Internal execq mutexes are declared as 'Mutex' with the name of the lock site.
+         * If execq is built with EXECQ_MUTEX_PROFILING, they are profiled. Otherwise 'Mutex' is plain std::mutex.
+         */
+#ifdef EXECQ_MUTEX_PROFILING
+        using Mutex = ProfiledMutex;
+        using MutexLockGuard = std::lock_guard<ProfiledMutex>;
+        using MutexUniqueLock = std::unique_lock<ProfiledMutex>;
+        using ConditionVariable = std::condition_variable_any;
+#else
+        class Mutex: public std::mutex
+        {
+        public:
+            explicit Mutex(const char*)
+            {}
+        };
+        using MutexLockGuard = std::lock_guard<std::mutex>;
+        using MutexUniqueLock = std::unique_lock<std::mutex>;
+        using ConditionVariable = std::condition_variable;
+#endif
+    }
+}
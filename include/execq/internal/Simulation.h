@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include "execq/ISimulation.h"
+#include "execq/internal/ThreadWorker.h"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <functional>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @class Simulation
+         * @brief Worker factory that runs workers in deterministic virtual time (see ISimulation).
+         * @discussion Pools with simulated workers do not use real-clock timers to let other workers steal local tasks:
+         * local task waits for its worker unless another worker looks for tasks itself.
+         */
+        class Simulation: public ISimulation, public IThreadWorkerFactory
+        {
+        public:
+            explicit Simulation(const SimulationOptions& options = SimulationOptions());
+            ~Simulation();
+            
+        public: // IThreadWorkerFactory
+            virtual std::unique_ptr<IThreadWorker> createWorker(ITaskProvider& provider, const ThreadWorkerOptions& options) const final;
+            virtual bool isSimulated() const final;
+            
+        public: // ISimulation
+            virtual void schedule(const std::chrono::nanoseconds time, std::function<void()> event) final;
+            virtual void run() final;
+            virtual std::chrono::nanoseconds now() const final;
+            virtual std::vector<SimulatedWorkerStats> workerStats() const final;
+            
+        public:
+            /**
+             * @brief Advances virtual time of the current task by 'cost'. Does nothing if called not from the simulated worker.
+             */
+            static void Consume(const std::chrono::nanoseconds cost);
+            
+        private:
+            struct Impl;
+            const std::unique_ptr<Impl> m_impl;
+        };
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @brief Parses Linux CPU list format like "0-3,8,10-11". The same format is used for NUMA node lists.
+         * @return CPU numbers in ascending order. Empty if the list is malformed.
+         */
+        std::vector<uint32_t> ParseCpuList(const std::string& cpuList);
+        
+        /**
+         * @brief Parses cgroup v2 'cpu.max' content like "400000 100000".
+         * @return CPU limit in CPUs. Zero if there is no limit or the content is malformed.
+         */
+        double ParseCgroupV2CpuMax(const std::string& cpuMax);
+        
+        /**
+         * @brief Converts cgroup v1 'cpu.cfs_quota_us' and 'cpu.cfs_period_us' contents into CPU limit.
+         * @return CPU limit in CPUs. Zero if there is no limit (quota is -1) or the contents are malformed.
+         */
+        double ParseCgroupV1CpuQuota(const std::string& quota, const std::string& period);
+        
+        /**
+         * @brief Returns CPU limit of the cgroup the process belongs to. Zero if there is no limit.
+         * @discussion Both cgroup v2 and v1 hierarchies are checked. Value is read each time the function is called.
+         */
+        double GetCgroupCpuLimit();
+        
+        /**
+         * @brief Returns number of CPUs the process is allowed to run on. Zero if unknown.
+         */
+        uint32_t GetAffinityCpuCount();
+        
+        /**
+         * @brief Returns CPUs of each NUMA node. Empty if NUMA topology is not available.
+         */
+        std::vector<std::vector<uint32_t>> GetNumaNodeCpus();
+        
+        /**
+         * @brief Binds current thread to specified CPUs. Does nothing on platforms that do not support it.
+         */
+        bool SetCurrentThreadAffinity(const std::vector<uint32_t>& cpus);
+        
+        /**
+         * @brief Returns CPU the current thread is running on or -1 if unknown.
+         */
+        int GetCurrentCpu();
+        
+        /**
+         * @brief Sets name of the current thread. Does nothing on platforms that do not support it.
+         */
+        bool SetCurrentThreadName(const std::string& name);
+        
+        /**
+         * @brief Sets scheduling policy and priority of the current thread.
+         */
+        bool SetCurrentThreadScheduling(const int policy, const int priority);
+        
+        /**
+         * @brief Sets nice value of the current thread. Supported only on Linux.
+         */
+        bool SetCurrentThreadNice(const int niceValue);
+        
+        /**
+         * @brief Returns CPU time consumed by the current thread. Zero on platforms without per-thread CPU clock.
+         */
+        std::chrono::nanoseconds GetCurrentThreadCpuTime();
+    }
+}
@@ -0,0 +1,78 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include "execq/ITaskGroup.h"
+#include "execq/internal/CancelTokenProvider.h"
+#include "execq/internal/ExecutionPool.h"
+
+#include <queue>
+#include <condition_variable>
+
+namespace execq
+{
+    namespace impl
+    {
+        class TaskGroup: public ITaskGroup, private ITaskProvider
+        {
+        public:
+            explicit TaskGroup(std::shared_ptr<IExecutionPool> executionPool);
+            ~TaskGroup();
+            
+        public: // ITaskGroup
+            virtual void run(std::function<void(const std::atomic_bool& isCanceled)> task) final;
+            virtual std::vector<std::exception_ptr> wait() final;
+            virtual void cancel() final;
+            
+        private: // ITaskProvider
+            virtual Task nextTask() final;
+            
+        private:
+            struct GroupTask
+            {
+                std::function<void(const std::atomic_bool& isCanceled)> function;
+                CancelToken cancelToken;
+            };
+            
+            bool executeNextTask();
+            void finishTask();
+            
+        private:
+            std::atomic_size_t m_pendingCount { 0 };
+            
+            std::atomic_bool m_hasTask { false };
+            std::queue<GroupTask> m_tasks;
+            std::vector<std::exception_ptr> m_exceptions;
+            std::mutex m_mutex;
+            std::condition_variable m_completeCondition;
+            
+            CancelTokenProvider m_cancelTokenProvider;
+            
+            const std::shared_ptr<IExecutionPool> m_executionPool;
+            const uint32_t m_traceNameId = 0;
+        };
+    }
+}
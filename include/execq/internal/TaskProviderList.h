@@ -24,10 +24,15 @@
 
 #pragma once
 
+#include "execq/internal/ProfiledMutex.h"
 #include "execq/internal/ThreadWorker.h"
 
+#include <map>
 #include <mutex>
-#include <list>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <unordered_map>
 
 namespace execq
 {
@@ -35,18 +40,60 @@ namespace execq
     {
         class TaskProviderList: public ITaskProvider
         {
+        public:
+            explicit TaskProviderList(const bool earliestDeadlineFirst = false);
+            ~TaskProviderList();
+            
         public: // ITaskProvider
             virtual Task nextTask() final;
             
         public:
+            /**
+             * @discussion Providers are published as immutable snapshot, so adding and removing never blocks 'nextTask'.
+             * 'removeProvider' returns only when no thread uses the removed provider anymore.
+             */
             void addProvider(ITaskProvider& provider);
             void removeProvider(ITaskProvider& provider);
             
+            /**
+             * @brief Updates deadline of the next provider's task. Has effect only in 'earliest-deadline-first' mode.
+             * @discussion Providers without deadline (time_point::max) are served 'by turn'.
+             */
+            void setProviderDeadline(ITaskProvider& provider, const std::chrono::steady_clock::time_point deadline);
+            
+            size_t providerCount() const;
+            
+            /**
+             * @brief Appends resource usage of providers that account it.
+             */
+            void appendProviderUsage(std::vector<ResourceUsage>& usage);
+            
         private:
-            using TaskProviders_lt = std::list<ITaskProvider*>;
-            TaskProviders_lt m_taskProviders;
-            TaskProviders_lt::iterator m_currentTaskProviderIt;
-            std::mutex m_mutex;
+            using TaskProviders_t = std::vector<ITaskProvider*>;
+            
+            Task nextDeadlineTask();
+            void removeProviderDeadline(ITaskProvider& provider);
+            void publishProviders(const TaskProviders_t* providers);
+            size_t beginRead();
+            void endRead(const size_t readerSlot);
+            
+        private:
+            std::atomic<const TaskProviders_t*> m_taskProviders;
+            std::atomic_size_t m_currentTaskProvider { 0 };
+            std::atomic_size_t m_providerCount { 0 };
+            
+            // Readers register in the counter of the current epoch. Writer switches the epoch and waits the old one drains.
+            std::atomic<uint64_t> m_readEpoch { 0 };
+            std::atomic_size_t m_readerCounts[2];
+            Mutex m_writerMutex { "TaskProviderList::m_writerMutex" };
+            
+            // Providers ordered by deadline of their next task. Contains only providers with deadline.
+            using ProviderDeadlines_mt = std::multimap<std::chrono::steady_clock::time_point, ITaskProvider*>;
+            const bool m_earliestDeadlineFirst = false;
+            ProviderDeadlines_mt m_providerDeadlines;
+            std::unordered_map<ITaskProvider*, ProviderDeadlines_mt::iterator> m_providerDeadlinePositions;
+            std::atomic_bool m_hasProviderDeadlines { false };
+            Mutex m_deadlineMutex { "TaskProviderList::m_deadlineMutex" };
         };
     }
 }
@@ -0,0 +1,57 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <memory>
+#include <thread>
+#include <functional>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @brief Joinable thread with configurable stack size.
+         * @discussion std::thread does not allow to specify stack size, so on POSIX systems the thread is created directly with pthreads.
+         */
+        class Thread
+        {
+        public:
+            Thread(std::function<void()> function, const size_t stackSize);
+            ~Thread();
+            
+            Thread(const Thread&) = delete;
+            Thread& operator=(const Thread&) = delete;
+            
+            void join();
+            bool joinable() const;
+            
+        private:
+            struct Impl;
+            std::unique_ptr<Impl> m_impl;
+        };
+    }
+}
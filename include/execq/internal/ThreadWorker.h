@@ -24,10 +24,15 @@
 
 #pragma once
 
+#include "execq/ExecutionOptions.h"
+#include "execq/internal/UsageAccounting.h"
+
 #include <mutex>
 #include <atomic>
+#include <chrono>
 #include <thread>
 #include <future>
+#include <vector>
 #include <condition_variable>
 
 namespace execq
@@ -41,6 +46,48 @@ namespace execq
             virtual ~ITaskProvider() = default;
             
             virtual Task nextTask() = 0;
+            
+            /**
+             * @brief Resource usage counters of the provider. Null if the provider does not account usage.
+             */
+            virtual const UsageCounters* usageCounters() const { return nullptr; }
+            
+            /**
+             * @brief Called on the worker thread when it starts and right before it exits.
+             */
+            virtual void workerStarted() {}
+            virtual void workerStopped() {}
+        };
+        
+        
+        struct ThreadWorkerOptions
+        {
+            /**
+             * @brief Time after which idle worker thread exits. Zero means the thread lives as long as the worker.
+             * @discussion Exited thread is started again on the next notification.
+             */
+            std::chrono::milliseconds idleTimeout { 0 };
+            
+            /**
+             * @brief Starts the thread when the worker is created instead of the first notification.
+             * @discussion Started thread warms up allocator caches, pre-faults its stack and parks until notified.
+             */
+            bool startEagerly = false;
+            
+            /**
+             * @brief Size of stack pre-faulted by eagerly started thread.
+             */
+            size_t prefaultStackSize = 0;
+            
+            /**
+             * @brief CPUs the thread is bound to. Empty means no binding.
+             */
+            std::vector<uint32_t> cpuAffinity;
+            
+            /**
+             * @brief Attributes of the thread.
+             */
+            ThreadOptions threadOptions;
         };
         
         
@@ -53,6 +100,16 @@ namespace execq
         };
         
         
+        namespace details
+        {
+            /**
+             * @brief Marks the worker of the current thread as notified, so notifications go to other workers.
+             * @discussion Used when the task blocks the worker for a long time. Does nothing on non-worker thread.
+             */
+            void MarkCurrentThreadWorkerNotified();
+        }
+        
+        
         class IThreadWorkerFactory
         {
         public:
@@ -60,7 +117,12 @@ namespace execq
             
             virtual ~IThreadWorkerFactory() = default;
             
-            virtual std::unique_ptr<impl::IThreadWorker> createWorker(impl::ITaskProvider& provider) const = 0;
+            virtual std::unique_ptr<impl::IThreadWorker> createWorker(impl::ITaskProvider& provider, const ThreadWorkerOptions& options) const = 0;
+            
+            /**
+             * @brief Returns true if workers run in virtual time (see Simulation), so the pool must not rely on real-clock timers.
+             */
+            virtual bool isSimulated() const { return false; }
         };
     }
 }
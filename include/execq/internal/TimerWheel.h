@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <list>
+#include <limits>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <functional>
+#include <condition_variable>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @class TimerWheel
+         * @brief Hashed timing wheel that fires callbacks on its own single thread.
+         * @discussion Scheduling and canceling are O(1). Occupied slots are marked in the bitmap, so the thread
+         * sleeps until the tick of the next occupied slot and then processes only the slots of the elapsed ticks.
+         * Timers that are farther than one revolution stay in the slot and wait their round.
+         */
+        class TimerWheel
+        {
+        public:
+            using Clock = std::chrono::steady_clock;
+            
+            struct Timer;
+            using TimerHandle = std::shared_ptr<Timer>;
+            
+            static std::shared_ptr<TimerWheel> shared();
+            
+            TimerWheel(const std::chrono::milliseconds resolution, const size_t slotCount);
+            ~TimerWheel();
+            
+            TimerHandle schedule(const Clock::time_point expiration, std::function<void()> callback);
+            
+            /**
+             * @brief Cancels the timer.
+             * @discussion If the timer callback is being executed right now, waits until it is done.
+             * @return true if the timer was canceled before its callback is called.
+             */
+            bool cancel(const TimerHandle& timer);
+            
+        private:
+            using TimerList_lt = std::list<TimerHandle>;
+            
+            void threadMain();
+            uint64_t tickForTime(const Clock::time_point time) const;
+            Clock::time_point timeForTick(const uint64_t tick) const;
+            uint64_t nextOccupiedTick() const;
+            void markSlot(const size_t slot, const bool occupied);
+            void collectExpiredTimers(const uint64_t currentTick, std::vector<TimerHandle>& expiredTimers);
+            
+        private:
+            const std::chrono::milliseconds m_resolution;
+            const Clock::time_point m_startTime;
+            
+            std::vector<TimerList_lt> m_slots;
+            std::vector<uint64_t> m_occupiedSlots;
+            size_t m_timerCount = 0;
+            uint64_t m_processedTick = 0;
+            uint64_t m_wakeupTick = std::numeric_limits<uint64_t>::max();
+            
+            bool m_shouldQuit = false;
+            std::mutex m_mutex;
+            std::condition_variable m_condition;
+            std::condition_variable m_callbackCondition;
+            std::unique_ptr<std::thread> m_thread;
+        };
+        
+        struct TimerWheel::Timer
+        {
+            enum class State
+            {
+                Scheduled,
+                Expired,
+                Running,
+                Done,
+            };
+            
+            std::function<void()> callback;
+            uint64_t expirationTick = 0;
+            State state = State::Scheduled;
+            size_t slot = 0;
+            TimerList_lt::iterator position;
+        };
+    }
+}
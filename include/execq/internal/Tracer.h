@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#pragma once
+
+#include <string>
+#include <cstdint>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @brief Returns true if task execution events should be recorded. See 'StartTracing'.
+         */
+        bool TracingEnabled();
+        
+        /**
+         * @brief Returns id of the name used in trace events. Names are never unregistered, so the same names share the id.
+         */
+        uint32_t RegisterTraceName(const std::string& name);
+        
+        /**
+         * @brief Returns the name registered with 'RegisterTraceName'. Empty if the id is unknown.
+         */
+        std::string TraceName(const uint32_t nameId);
+        
+        /**
+         * @brief Sets the name of the current thread used in trace. Unnamed threads are shown as 'thread <N>'.
+         */
+        void SetCurrentThreadTraceName(const std::string& name);
+        
+        /**
+         * @brief Records event that happened at single moment (i.e. worker wakeup) on the current thread.
+         */
+        void TraceInstant(const uint32_t nameId);
+        
+        
+        /**
+         * @class TraceScope
+         * @brief Records begin event when created and end event when destroyed. Does nothing if tracing is not enabled.
+         */
+        class TraceScope
+        {
+        public:
+            TraceScope(const uint32_t nameId, const void* provider);
+            ~TraceScope();
+            
+            TraceScope(const TraceScope&) = delete;
+            TraceScope& operator=(const TraceScope&) = delete;
+            
+        private:
+            const uint32_t m_nameId;
+            const void* const m_provider;
+            bool m_enabled = false;
+        };
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include "execq/ResourceUsage.h"
+
+#include <atomic>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @class UsageCounters
+         * @brief Lock-free totals of resources consumed by the tasks of single queue or stream.
+         */
+        class UsageCounters
+        {
+        public:
+            UsageCounters(const std::string& name, const std::string& tag);
+            
+            void record(const std::chrono::nanoseconds cpuTime, const std::chrono::nanoseconds wallTime);
+            ResourceUsage snapshot() const;
+            
+        private:
+            const std::string m_name;
+            const std::string m_tag;
+            std::atomic<uint64_t> m_taskCount { 0 };
+            std::atomic<uint64_t> m_cpuTime { 0 };
+            std::atomic<uint64_t> m_wallTime { 0 };
+        };
+        
+        
+        /**
+         * @class UsageScope
+         * @brief Records CPU and wall time of the current thread between creation and destruction. Does nothing if counters are null.
+         * @discussion Scopes nest when the thread executes other tasks while waiting (i.e. helps the pool).
+         * Time of the nested scope is recorded only by the nested scope and is excluded from the outer one.
+         */
+        class UsageScope
+        {
+        public:
+            explicit UsageScope(UsageCounters* counters);
+            ~UsageScope();
+            
+            UsageScope(const UsageScope&) = delete;
+            UsageScope& operator=(const UsageScope&) = delete;
+            
+        private:
+            UsageCounters* const m_counters;
+            UsageScope* m_parent = nullptr;
+            std::chrono::nanoseconds m_cpuStart { 0 };
+            std::chrono::steady_clock::time_point m_wallStart;
+            std::chrono::nanoseconds m_nestedCpuTime { 0 };
+            std::chrono::nanoseconds m_nestedWallTime { 0 };
+        };
+    }
+}
@@ -0,0 +1,61 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#pragma once
+
+#include <cstdint>
+
+namespace execq
+{
+    namespace impl
+    {
+        /**
+         * @brief Returns true if task start times and queue waits should be tracked. See 'StartWatchdog'.
+         */
+        bool WatchdogEnabled();
+        
+        
+        /**
+         * @class WatchdogScope
+         * @brief Marks the current thread as running the task with given trace name while alive. Does nothing if watchdog is not enabled.
+         * @discussion Scopes may be nested (i.e. thread waiting for nested task executes other tasks): outer task is restored on destruction.
+         */
+        class WatchdogScope
+        {
+        public:
+            explicit WatchdogScope(const uint32_t nameId);
+            ~WatchdogScope();
+            
+            WatchdogScope(const WatchdogScope&) = delete;
+            WatchdogScope& operator=(const WatchdogScope&) = delete;
+            
+        private:
+            const bool m_enabled = false;
+            uint32_t m_previousNameId = 0;
+            int64_t m_previousStartTime = 0;
+        };
+    }
+}
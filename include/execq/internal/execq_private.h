@@ -26,6 +26,9 @@
 
 #include "execq/internal/ExecutionQueue.h"
 
+#include <algorithm>
+#include <chrono>
+
 namespace execq
 {
     namespace details
@@ -41,49 +44,69 @@ namespace execq
     }
 }
 
+template <typename Future>
+void execq::WaitHelping(const std::shared_ptr<IExecutionPool>& executionPool, const Future& future)
+{
+    impl::details::WaitHelpingUntil([&] {
+        return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+    }, [&] {
+        return executionPool->executeNextTask();
+    }, [&] (const std::chrono::microseconds backoff) {
+        future.wait_for(backoff);
+    });
+}
+
 template <typename R, typename T>
 std::unique_ptr<execq::IExecutionQueue<R(T)>> execq::CreateConcurrentExecutionQueue(std::shared_ptr<IExecutionPool> executionPool,
-                                                                                    std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor)
+                                                                                    std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor,
+                                                                                    const ExecutionQueueOptions& options)
 {
     return std::unique_ptr<impl::ExecutionQueue<R, T>>(new impl::ExecutionQueue<R, T>(false,
                                                                                       executionPool,
-                                                                                      *impl::IThreadWorkerFactory::defaultFactory(),
-                                                                                      std::move(executor)));
+                                                                                      impl::details::AdditionalWorkerFactory(executionPool.get()),
+                                                                                      std::move(executor),
+                                                                                      options));
 }
 
 template <typename R, typename T>
 std::unique_ptr<execq::IExecutionQueue<R(T)>> execq::CreateSerialExecutionQueue(std::shared_ptr<IExecutionPool> executionPool,
-                                                                                std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor)
+                                                                                std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor,
+                                                                                const ExecutionQueueOptions& options)
 {
-    return std::unique_ptr<impl::ExecutionQueue<R, T>>(new impl::ExecutionQueue<R, T>(false,
+    return std::unique_ptr<impl::ExecutionQueue<R, T>>(new impl::ExecutionQueue<R, T>(true,
                                                                                       executionPool,
-                                                                                      *impl::IThreadWorkerFactory::defaultFactory(),
-                                                                                      std::move(executor)));
+                                                                                      impl::details::AdditionalWorkerFactory(executionPool.get()),
+                                                                                      std::move(executor),
+                                                                                      options));
 }
 
 template <typename R, typename T>
-std::unique_ptr<execq::IExecutionQueue<R(T)>> execq::CreateSerialExecutionQueue(std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor)
+std::unique_ptr<execq::IExecutionQueue<R(T)>> execq::CreateSerialExecutionQueue(std::function<R(const std::atomic_bool& isCanceled, T&& object)> executor,
+                                                                                const ExecutionQueueOptions& options)
 {
     return std::unique_ptr<impl::ExecutionQueue<R, T>>(new impl::ExecutionQueue<R, T>(true,
                                                                                       nullptr,
                                                                                       *impl::IThreadWorkerFactory::defaultFactory(),
-                                                                                      std::move(executor)));
+                                                                                      std::move(executor),
+                                                                                      options));
 }
 
 template <typename R>
-std::unique_ptr<execq::IExecutionQueue<void(execq::QueueTask<R>)>> execq::CreateConcurrentTaskExecutionQueue(std::shared_ptr<IExecutionPool> executionPool)
+std::unique_ptr<execq::IExecutionQueue<void(execq::QueueTask<R>)>> execq::CreateConcurrentTaskExecutionQueue(std::shared_ptr<IExecutionPool> executionPool,
+                                                                                                             const ExecutionQueueOptions& options)
 {
-    return CreateConcurrentExecutionQueue<void, QueueTask<R>>(executionPool, &details::ExecuteQueueTask<R>);
+    return CreateConcurrentExecutionQueue<void, QueueTask<R>>(executionPool, &details::ExecuteQueueTask<R>, options);
 }
 
 template <typename R>
-std::unique_ptr<execq::IExecutionQueue<void(execq::QueueTask<R>)>> execq::CreateSerialTaskExecutionQueue(std::shared_ptr<IExecutionPool> executionPool)
+std::unique_ptr<execq::IExecutionQueue<void(execq::QueueTask<R>)>> execq::CreateSerialTaskExecutionQueue(std::shared_ptr<IExecutionPool> executionPool,
+                                                                                                         const ExecutionQueueOptions& options)
 {
-    return CreateSerialExecutionQueue<void, QueueTask<R>>(executionPool, &details::ExecuteQueueTask<R>);
+    return CreateSerialExecutionQueue<void, QueueTask<R>>(executionPool, &details::ExecuteQueueTask<R>, options);
 }
 
 template <typename R>
-std::unique_ptr<execq::IExecutionQueue<void(execq::QueueTask<R>)>> execq::CreateSerialTaskExecutionQueue()
+std::unique_ptr<execq::IExecutionQueue<void(execq::QueueTask<R>)>> execq::CreateSerialTaskExecutionQueue(const ExecutionQueueOptions& options)
 {
-    return CreateSerialExecutionQueue<void, QueueTask<R>>(&details::ExecuteQueueTask<R>);
+    return CreateSerialExecutionQueue<void, QueueTask<R>>(&details::ExecuteQueueTask<R>, options);
 }
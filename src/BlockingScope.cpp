@@ -0,0 +1,56 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "BlockingScope.h"
+#include "ExecutionPool.h"
+
+namespace
+{
+    thread_local bool t_insideBlockingScope = false;
+}
+
+execq::BlockingScope::BlockingScope()
+{
+    if (t_insideBlockingScope)
+    {
+        return;
+    }
+    
+    m_executionPool = impl::details::CurrentThreadExecutionPool();
+    if (m_executionPool)
+    {
+        t_insideBlockingScope = true;
+        m_executionPool->beginBlocking();
+    }
+}
+
+execq::BlockingScope::~BlockingScope()
+{
+    if (m_executionPool)
+    {
+        m_executionPool->endBlocking();
+        t_insideBlockingScope = false;
+    }
+}
@@ -23,10 +23,11 @@
  */
 
 #include "CancelTokenProvider.h"
+#include "Probes.h"
 
 execq::impl::CancelToken execq::impl::CancelTokenProvider::token()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    MutexLockGuard lock(m_mutex);
     return m_currentToken;
 }
 
@@ -42,7 +43,9 @@ void execq::impl::CancelTokenProvider::cancelAndRenew()
 
 void execq::impl::CancelTokenProvider::cancelAndRenew(const bool renew)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    EXECQ_PROBE1(cancel, this);
+    
+    MutexLockGuard lock(m_mutex);
     if (m_currentToken)
     {
         *m_currentToken = true;
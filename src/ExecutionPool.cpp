@@ -23,43 +23,692 @@
  */
 
 #include "ExecutionPool.h"
+#include "LocalTaskQueue.h"
+#include "MetricsRegistry.h"
+#include "Probes.h"
+#include "SystemInfo.h"
+#include "TimerWheel.h"
+#include "execq.h"
 
-execq::impl::ExecutionPool::ExecutionPool(const uint32_t threadCount, const IThreadWorkerFactory& workerFactory)
+#include <limits>
+#include <thread>
+#include <algorithm>
+
+namespace
+{
+    const size_t kUnknownNodeIndex = static_cast<size_t>(-1);
+    const std::chrono::milliseconds kCompensatingThreadIdleTimeout { 1000 };
+    
+    const uint32_t kNotCompensatingIndex = static_cast<uint32_t>(-1);
+    
+    // Owner executes local tasks one after another, but each N-th time it checks shared tasks first to not starve them.
+    const uint32_t kMaxLocalTaskStreak = 61;
+    
+    // Task that stays in the LIFO slot of busy worker longer than that is handed to other workers.
+    const std::chrono::milliseconds kLocalTaskStealDelay { 1 };
+    
+    const size_t kCacheLineSize = 64;
+    
+    thread_local execq::IExecutionPool* t_currentThreadExecutionPool = nullptr;
+    thread_local execq::impl::ITaskProvider* t_currentWorkerProvider = nullptr;
+    
+    std::vector<std::vector<uint32_t>> GetNodeCpus(const execq::ExecutionPoolOptions& options)
+    {
+        std::vector<std::vector<uint32_t>> nodeCpus;
+        if (options.numaAware)
+        {
+            for (std::vector<uint32_t>& cpus : execq::impl::GetNumaNodeCpus())
+            {
+                if (!options.cpuAffinity.empty())
+                {
+                    std::vector<uint32_t> allowedCpus;
+                    std::set_intersection(cpus.begin(), cpus.end(),
+                                          options.cpuAffinity.begin(), options.cpuAffinity.end(),
+                                          std::back_inserter(allowedCpus));
+                    cpus.swap(allowedCpus);
+                }
+                
+                if (!cpus.empty())
+                {
+                    nodeCpus.push_back(std::move(cpus));
+                }
+            }
+        }
+        
+        // Single node pool is the same as non-NUMA one.
+        if (nodeCpus.size() < 2)
+        {
+            nodeCpus.assign(1, options.cpuAffinity);
+        }
+        
+        if (nodeCpus.size() > options.threadCount)
+        {
+            nodeCpus.resize(options.threadCount);
+        }
+        
+        return nodeCpus;
+    }
+    
+    uint32_t GetNodeShare(const uint32_t count, const size_t nodeIndex, const size_t nodeCount)
+    {
+        return static_cast<uint32_t>(count / nodeCount + (nodeIndex < count % nodeCount ? 1 : 0));
+    }
+}
+
+class execq::impl::ExecutionPool::WorkerTaskProvider: public ITaskProvider
+{
+public:
+    WorkerTaskProvider(ExecutionPool& pool, const size_t nodeIndex, const size_t nodeCount, const uint32_t workerIndex,
+                       const uint32_t compensatingIndex)
+    : m_pool(pool)
+    , m_nodeIndex(nodeIndex)
+    , m_nodeCount(nodeCount)
+    , m_workerIndex(workerIndex)
+    , m_compensatingIndex(compensatingIndex)
+    {}
+    
+    virtual Task nextTask() final
+    {
+        t_currentThreadExecutionPool = &m_pool;
+        t_currentWorkerProvider = this;
+        
+        // The previous call ends either the task or waiting for notification.
+        const bool wasParked = m_counters.parked.load(std::memory_order_relaxed);
+        accountElapsedTime();
+        
+        // Compensating thread takes shared tasks only while there are enough blocked threads to compensate.
+        const bool takeSharedTasks = m_compensatingIndex == kNotCompensatingIndex || m_compensatingIndex < m_pool.m_blockedThreadCount;
+        Task task = m_pool.nextWorkerTask(*this, takeSharedTasks);
+        
+        const bool found = task.valid();
+        Increment(found ? m_counters.tasksExecuted : m_counters.emptyScans, 1);
+        if (wasParked)
+        {
+            Increment(m_counters.wakeups, 1);
+            Increment(m_counters.usefulWakeups, found ? 1 : 0);
+        }
+        m_counters.parked.store(!found, std::memory_order_relaxed);
+        
+        return task;
+    }
+    
+    virtual void workerStarted() final
+    {
+        // Time is accounted only while the thread runs: not started and exited workers are neither busy nor idle.
+        m_counters.lastCheckTime.store(CurrentTimeNs(), std::memory_order_relaxed);
+        m_counters.parked.store(true, std::memory_order_relaxed);
+        m_counters.running.store(true, std::memory_order_relaxed);
+    }
+    
+    virtual void workerStopped() final
+    {
+        accountElapsedTime();
+        m_counters.running.store(false, std::memory_order_relaxed);
+    }
+    
+public:
+    size_t nodeIndex() const
+    {
+        return m_compensatingIndex == kNotCompensatingIndex ? m_nodeIndex : m_pool.currentOrFirstNodeIndex();
+    }
+    
+    WorkerStats stats() const
+    {
+        WorkerStats stats;
+        stats.tasksExecuted = m_counters.tasksExecuted.load(std::memory_order_relaxed);
+        stats.busyTime = std::chrono::nanoseconds(m_counters.busyTime.load(std::memory_order_relaxed));
+        stats.idleTime = std::chrono::nanoseconds(m_counters.idleTime.load(std::memory_order_relaxed));
+        stats.wakeups = m_counters.wakeups.load(std::memory_order_relaxed);
+        stats.usefulWakeups = m_counters.usefulWakeups.load(std::memory_order_relaxed);
+        stats.emptyScans = m_counters.emptyScans.load(std::memory_order_relaxed);
+        stats.parked = m_counters.parked.load(std::memory_order_relaxed);
+        stats.running = m_counters.running.load(std::memory_order_relaxed);
+        stats.active = stats.running && isActive();
+        
+        // Account the current period up to now.
+        if (stats.running && (!stats.parked || stats.active))
+        {
+            const uint64_t lastCheckTime = m_counters.lastCheckTime.load(std::memory_order_relaxed);
+            const std::chrono::nanoseconds sinceLastCheck(std::max(CurrentTimeNs(), lastCheckTime) - lastCheckTime);
+            (stats.parked ? stats.idleTime : stats.busyTime) += sinceLastCheck;
+        }
+        
+        return stats;
+    }
+    
+private:
+    /**
+     * @brief Worker is active if the pool may notify it: it is within the thread limit or compensates the blocked thread.
+     * @discussion Idle time of inactive workers is not the idle capacity of the pool, so it is not accounted.
+     */
+    bool isActive() const
+    {
+        return m_compensatingIndex == kNotCompensatingIndex
+        ? m_workerIndex < GetNodeShare(m_pool.m_threadLimit, m_nodeIndex, m_nodeCount)
+        : m_compensatingIndex < m_pool.m_blockedThreadCount;
+    }
+    
+    void accountElapsedTime()
+    {
+        const uint64_t now = CurrentTimeNs();
+        const bool parked = m_counters.parked.load(std::memory_order_relaxed);
+        if (!parked || isActive())
+        {
+            Increment(parked ? m_counters.idleTime : m_counters.busyTime, now - m_counters.lastCheckTime.load(std::memory_order_relaxed));
+        }
+        m_counters.lastCheckTime.store(now, std::memory_order_relaxed);
+    }
+    
+    static uint64_t CurrentTimeNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    static void Increment(std::atomic<uint64_t>& counter, const uint64_t value)
+    {
+        // Counters are written only by the worker thread, so plain store is enough and does not lock the bus.
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @discussion Padding keeps counters of different workers in different cache lines,
+     * so collecting statistics does not cause false sharing.
+     */
+    struct Counters
+    {
+        char paddingBefore[kCacheLineSize];
+        std::atomic<uint64_t> tasksExecuted { 0 };
+        std::atomic<uint64_t> busyTime { 0 };
+        std::atomic<uint64_t> idleTime { 0 };
+        std::atomic<uint64_t> wakeups { 0 };
+        std::atomic<uint64_t> usefulWakeups { 0 };
+        std::atomic<uint64_t> emptyScans { 0 };
+        std::atomic<uint64_t> lastCheckTime { CurrentTimeNs() };
+        std::atomic_bool parked { true };
+        std::atomic_bool running { false };
+        char paddingAfter[kCacheLineSize];
+    };
+    
+public:
+    LocalTaskQueue localTasks;
+    uint32_t localTaskStreak = 0;
+    std::atomic_bool stealTimerScheduled { false };
+    TimerWheel::TimerHandle stealTimer;
+    std::mutex stealTimerMutex;
+    
+private:
+    ExecutionPool& m_pool;
+    const size_t m_nodeIndex;
+    const size_t m_nodeCount;
+    const uint32_t m_workerIndex;
+    const uint32_t m_compensatingIndex;
+    Counters m_counters;
+};
+
+execq::impl::ExecutionPool::Node::Node(const bool earliestDeadlineFirst)
+: providers(earliestDeadlineFirst)
+{}
+
+execq::impl::ExecutionPool::ExecutionPool(const ExecutionPoolOptions& options, const IThreadWorkerFactory& workerFactory)
+: m_workerFactory(workerFactory)
+, m_autoThreadCount(!options.threadCount)
+, m_stealTimerEnabled(!workerFactory.isSimulated())
+{
+    // Auto-sized pool has workers for all hardware threads, but uses only the optimal number of them.
+    // Workers start lazily, so the ones above the limit cost nothing until the limit is raised.
+    const uint32_t optimalThreadCount = m_autoThreadCount ? GetOptimalThreadCount() : options.threadCount;
+    const uint32_t threadCount = std::max(optimalThreadCount, m_autoThreadCount ? std::thread::hardware_concurrency() : 0);
+    m_threadLimit = optimalThreadCount;
+    
+    std::vector<uint32_t> sortedCpuAffinity = options.cpuAffinity;
+    std::sort(sortedCpuAffinity.begin(), sortedCpuAffinity.end());
+    
+    m_additionalWorkerOptions.startEagerly = options.startThreadsEagerly;
+    m_additionalWorkerOptions.prefaultStackSize = options.prefaultStackSize;
+    m_additionalWorkerOptions.cpuAffinity = sortedCpuAffinity;
+    
+    ExecutionPoolOptions nodeOptions = options;
+    nodeOptions.cpuAffinity = sortedCpuAffinity;
+    nodeOptions.threadCount = threadCount;
+    const std::vector<std::vector<uint32_t>> nodeCpus = GetNodeCpus(nodeOptions);
+    
+    for (size_t nodeIndex = 0; nodeIndex < nodeCpus.size(); nodeIndex++)
+    {
+        std::unique_ptr<Node> node(new Node(options.earliestDeadlineFirst));
+        
+        ThreadWorkerOptions persistentWorkerOptions = m_additionalWorkerOptions;
+        persistentWorkerOptions.cpuAffinity = nodeCpus[nodeIndex];
+        persistentWorkerOptions.threadOptions = options.threadOptions;
+        
+        ThreadWorkerOptions elasticWorkerOptions = persistentWorkerOptions;
+        elasticWorkerOptions.idleTimeout = options.idleThreadTimeout;
+        
+        // Workers are notified in order, so the first ones are busy most of the time and the last ones retire first.
+        const uint32_t nodeThreadCount = GetNodeShare(threadCount, nodeIndex, nodeCpus.size());
+        const uint32_t nodeThreadLimit = GetNodeShare(optimalThreadCount, nodeIndex, nodeCpus.size());
+        const uint32_t nodeMinThreadCount = GetNodeShare(options.minThreadCount, nodeIndex, nodeCpus.size());
+        for (uint32_t i = 0; i < nodeThreadCount; i++)
+        {
+            ThreadWorkerOptions workerOptions = i < nodeMinThreadCount ? persistentWorkerOptions : elasticWorkerOptions;
+            workerOptions.startEagerly = workerOptions.startEagerly && i < nodeThreadLimit;
+            m_workerProviders.emplace_back(new WorkerTaskProvider(*this, nodeIndex, nodeCpus.size(), i, kNotCompensatingIndex));
+            node->workers.emplace_back(workerFactory.createWorker(*m_workerProviders.back(), workerOptions));
+        }
+        
+        for (const uint32_t cpu : nodeCpus[nodeIndex])
+        {
+            if (m_cpuNodeIndices.size() <= cpu)
+            {
+                m_cpuNodeIndices.resize(cpu + 1, kUnknownNodeIndex);
+            }
+            m_cpuNodeIndices[cpu] = nodeIndex;
+        }
+        
+        m_nodes.push_back(std::move(node));
+    }
+    
+    ThreadWorkerOptions compensatingWorkerOptions = m_additionalWorkerOptions;
+    compensatingWorkerOptions.startEagerly = false;
+    compensatingWorkerOptions.idleTimeout = kCompensatingThreadIdleTimeout;
+    compensatingWorkerOptions.threadOptions = options.threadOptions;
+    for (uint32_t i = 0; i < options.maxCompensatingThreadCount; i++)
+    {
+        m_workerProviders.emplace_back(new WorkerTaskProvider(*this, 0, 1, 0, i));
+        m_compensatingWorkers.emplace_back(workerFactory.createWorker(*m_workerProviders.back(), compensatingWorkerOptions));
+    }
+    
+    RegisterMetricsPool(*this);
+}
+
+execq::impl::ExecutionPool::~ExecutionPool()
 {
-    for (uint32_t i = 0; i < threadCount; i++)
+    UnregisterMetricsPool(*this);
+    
+    // There are no queues at this point, so no new local tasks and timers appear.
+    for (const auto& workerProvider : m_workerProviders)
     {
-        m_workers.emplace_back(workerFactory.createWorker(m_providerGroup));
+        TimerWheel::TimerHandle stealTimer;
+        {
+            std::lock_guard<std::mutex> lock(workerProvider->stealTimerMutex);
+            stealTimer = workerProvider->stealTimer;
+        }
+        m_timerWheel->cancel(stealTimer);
+    }
+    
+    // Workers of one node take tasks from other nodes, so stop all of them before destroying nodes.
+    m_compensatingWorkers.clear();
+    for (const auto& node : m_nodes)
+    {
+        node->workers.clear();
     }
 }
 
 void execq::impl::ExecutionPool::addProvider(ITaskProvider& provider)
 {
-    m_providerGroup.addProvider(provider);
+    EXECQ_PROBE2(provider_add, this, &provider);
+    
+    if (m_nodes.size() == 1)
+    {
+        m_nodes.front()->providers.addProvider(provider);
+        return;
+    }
+    
+    // Provider is bound to the node of the thread that creates it: data it works with is likely allocated there.
+    size_t nodeIndex = currentNodeIndex();
+    {
+        std::lock_guard<std::mutex> lock(m_providerNodesMutex);
+        if (nodeIndex == kUnknownNodeIndex)
+        {
+            nodeIndex = m_nextProviderNodeIndex++ % m_nodes.size();
+        }
+        m_providerNodeIndices[&provider] = nodeIndex;
+    }
+    
+    m_nodes[nodeIndex]->providers.addProvider(provider);
 }
 
 void execq::impl::ExecutionPool::removeProvider(ITaskProvider& provider)
 {
-    m_providerGroup.removeProvider(provider);
+    EXECQ_PROBE2(provider_remove, this, &provider);
+    
+    providerNode(provider).providers.removeProvider(provider);
+    
+    if (m_nodes.size() > 1)
+    {
+        std::lock_guard<std::mutex> lock(m_providerNodesMutex);
+        m_providerNodeIndices.erase(&provider);
+    }
 }
 
 bool execq::impl::ExecutionPool::notifyOneWorker()
 {
-    return details::NotifyWorkers(m_workers, true);
+    // Prefer workers of the current node: the data of new task is likely there.
+    const size_t firstIndex = currentOrFirstNodeIndex();
+    const uint32_t threadLimit = m_threadLimit;
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+        const size_t nodeIndex = (firstIndex + i) % m_nodes.size();
+        if (details::NotifyWorkers(m_nodes[nodeIndex]->workers, true, GetNodeShare(threadLimit, nodeIndex, m_nodes.size())))
+        {
+            return true;
+        }
+    }
+    
+    return details::NotifyWorkers(m_compensatingWorkers, true, m_blockedThreadCount);
 }
 
 void execq::impl::ExecutionPool::notifyAllWorkers()
 {
-    details::NotifyWorkers(m_workers, false);
+    const uint32_t threadLimit = m_threadLimit;
+    for (size_t nodeIndex = 0; nodeIndex < m_nodes.size(); nodeIndex++)
+    {
+        details::NotifyWorkers(m_nodes[nodeIndex]->workers, false, GetNodeShare(threadLimit, nodeIndex, m_nodes.size()));
+    }
+    details::NotifyWorkers(m_compensatingWorkers, false, m_blockedThreadCount);
+}
+
+bool execq::impl::ExecutionPool::executeNextTask()
+{
+    // Pool thread waiting for something starts from its own local tasks: likely that is what it waits for.
+    Task task = t_currentThreadExecutionPool == this
+    ? nextWorkerTask(*static_cast<WorkerTaskProvider*>(t_currentWorkerProvider), true)
+    : nextNodeTask(currentOrFirstNodeIndex());
+    if (!task.valid())
+    {
+        return false;
+    }
+    
+    task();
+    
+    return true;
+}
+
+execq::impl::ThreadWorkerOptions execq::impl::ExecutionPool::additionalWorkerOptions() const
+{
+    return m_additionalWorkerOptions;
+}
+
+const execq::impl::IThreadWorkerFactory& execq::impl::ExecutionPool::workerFactory() const
+{
+    return m_workerFactory;
+}
+
+void execq::impl::ExecutionPool::setProviderDeadline(ITaskProvider& provider, const std::chrono::steady_clock::time_point deadline)
+{
+    providerNode(provider).providers.setProviderDeadline(provider, deadline);
+}
+
+void execq::impl::ExecutionPool::reevaluateThreadCount()
+{
+    if (!m_autoThreadCount)
+    {
+        return;
+    }
+    
+    size_t workerCount = 0;
+    for (const auto& node : m_nodes)
+    {
+        workerCount += node->workers.size();
+    }
+    
+    // Workers above the limit are not woken up anymore and go to sleep when they run out of tasks.
+    m_threadLimit = static_cast<uint32_t>(std::min<size_t>(std::max<uint32_t>(GetOptimalThreadCount(), 1), workerCount));
+}
+
+void execq::impl::ExecutionPool::beginBlocking()
+{
+    // Blocked worker should not take notifications: let them go to free and compensating workers.
+    details::MarkCurrentThreadWorkerNotified();
+    
+    const uint32_t blockedThreadCount = ++m_blockedThreadCount;
+    if (blockedThreadCount <= m_compensatingWorkers.size())
+    {
+        // Pool may already have pending tasks, so start compensating thread right now.
+        m_compensatingWorkers[blockedThreadCount - 1]->notifyWorker();
+    }
+}
+
+void execq::impl::ExecutionPool::endBlocking()
+{
+    m_blockedThreadCount--;
+}
+
+void execq::impl::ExecutionPool::pushLocalTask(Task task, ILocalTaskOwner& owner)
+{
+    WorkerTaskProvider& workerProvider = *static_cast<WorkerTaskProvider*>(t_currentWorkerProvider);
+    
+    // The current worker checks for tasks after the current one anyway, so it should not take notifications.
+    details::MarkCurrentThreadWorkerNotified();
+    
+    m_localTaskCount++;
+    if (workerProvider.localTasks.push(std::move(task), owner) && notifyOneWorker())
+    {
+        // Worker has more local tasks than it could execute next: let other workers steal them.
+        return;
+    }
+    
+    // Single task waits for the owner, but if the owner is busy for long, other workers should take it.
+    // Simulated workers live in virtual time, so real-clock timer would make the schedule non-deterministic.
+    if (m_stealTimerEnabled)
+    {
+        scheduleStealTimer(workerProvider);
+    }
+}
+
+void execq::impl::ExecutionPool::scheduleStealTimer(WorkerTaskProvider& workerProvider)
+{
+    if (workerProvider.stealTimerScheduled.exchange(true))
+    {
+        return;
+    }
+    
+    WorkerTaskProvider* workerProviderPtr = &workerProvider;
+    std::lock_guard<std::mutex> lock(workerProvider.stealTimerMutex);
+    workerProvider.stealTimer = m_timerWheel->schedule(TimerWheel::Clock::now() + kLocalTaskStealDelay, [this, workerProviderPtr] {
+        onStealTimer(*workerProviderPtr);
+    });
+}
+
+void execq::impl::ExecutionPool::onStealTimer(WorkerTaskProvider& workerProvider)
+{
+    workerProvider.stealTimerScheduled = false;
+    if (workerProvider.localTasks.empty())
+    {
+        return;
+    }
+    
+    if (notifyOneWorker())
+    {
+        // Notified worker could get busy before it steals the tasks: check them again later.
+        scheduleStealTimer(workerProvider);
+        return;
+    }
+    
+    // All workers are busy, maybe waiting for the local tasks themselves. Owners execute them on their own threads.
+    reclaimLocalTasks();
+}
+
+void execq::impl::ExecutionPool::reclaimLocalTasks()
+{
+    for (const auto& workerProvider : m_workerProviders)
+    {
+        while (true)
+        {
+            LocalTask localTask = workerProvider->localTasks.steal();
+            if (!localTask.task.valid())
+            {
+                break;
+            }
+            
+            m_localTaskCount--;
+            localTask.owner->reclaimLocalTask(std::move(localTask.task));
+        }
+    }
+}
+
+execq::ExecutionPoolStats execq::impl::ExecutionPool::stats() const
+{
+    ExecutionPoolStats stats;
+    for (const auto& node : m_nodes)
+    {
+        stats.providerCount += node->providers.providerCount();
+        node->providers.appendProviderUsage(stats.providerUsage);
+    }
+    
+    stats.workers.reserve(m_workerProviders.size());
+    for (const auto& workerProvider : m_workerProviders)
+    {
+        stats.workers.push_back(workerProvider->stats());
+        stats.parkedWorkerCount += stats.workers.back().parked ? 1 : 0;
+        stats.runningWorkerCount += stats.workers.back().running ? 1 : 0;
+    }
+    
+    return stats;
+}
+
+// Private
+
+execq::impl::Task execq::impl::ExecutionPool::nextWorkerTask(WorkerTaskProvider& workerProvider, const bool takeSharedTasks)
+{
+    const bool sharedTasksFirst = takeSharedTasks && ++workerProvider.localTaskStreak >= kMaxLocalTaskStreak;
+    if (sharedTasksFirst)
+    {
+        workerProvider.localTaskStreak = 0;
+    }
+    
+    Task task = sharedTasksFirst ? Task() : popLocalTask(workerProvider.localTasks);
+    if (task.valid())
+    {
+        return task;
+    }
+    
+    if (takeSharedTasks)
+    {
+        task = nextNodeTask(workerProvider.nodeIndex());
+        if (task.valid())
+        {
+            return task;
+        }
+    }
+    
+    if (sharedTasksFirst)
+    {
+        task = popLocalTask(workerProvider.localTasks);
+        if (task.valid())
+        {
+            return task;
+        }
+    }
+    
+    return takeSharedTasks ? stealLocalTask(workerProvider) : Task();
+}
+
+execq::impl::Task execq::impl::ExecutionPool::popLocalTask(LocalTaskQueue& localTasks)
+{
+    Task task = localTasks.pop();
+    if (task.valid())
+    {
+        m_localTaskCount--;
+    }
+    
+    return task;
+}
+
+execq::impl::Task execq::impl::ExecutionPool::stealLocalTask(const WorkerTaskProvider& thief)
+{
+    if (!m_localTaskCount)
+    {
+        return Task();
+    }
+    
+    for (const auto& workerProvider : m_workerProviders)
+    {
+        if (workerProvider.get() == &thief)
+        {
+            continue;
+        }
+        
+        LocalTask localTask = workerProvider->localTasks.steal();
+        if (localTask.task.valid())
+        {
+            m_localTaskCount--;
+            return std::move(localTask.task);
+        }
+    }
+    
+    return Task();
+}
+
+execq::impl::Task execq::impl::ExecutionPool::nextNodeTask(const size_t nodeIndex)
+{
+    for (size_t i = 0; i < m_nodes.size(); i++)
+    {
+        Task task = m_nodes[(nodeIndex + i) % m_nodes.size()]->providers.nextTask();
+        if (task.valid())
+        {
+            return task;
+        }
+    }
+    
+    return Task();
+}
+
+size_t execq::impl::ExecutionPool::currentOrFirstNodeIndex() const
+{
+    const size_t currentIndex = m_nodes.size() == 1 ? 0 : currentNodeIndex();
+    return currentIndex == kUnknownNodeIndex ? 0 : currentIndex;
+}
+
+size_t execq::impl::ExecutionPool::currentNodeIndex() const
+{
+    const int cpu = GetCurrentCpu();
+    if (cpu < 0 || static_cast<size_t>(cpu) >= m_cpuNodeIndices.size())
+    {
+        return kUnknownNodeIndex;
+    }
+    
+    return m_cpuNodeIndices[cpu];
+}
+
+execq::impl::ExecutionPool::Node& execq::impl::ExecutionPool::providerNode(ITaskProvider& provider)
+{
+    if (m_nodes.size() == 1)
+    {
+        return *m_nodes.front();
+    }
+    
+    std::lock_guard<std::mutex> lock(m_providerNodesMutex);
+    const auto it = m_providerNodeIndices.find(&provider);
+    return *m_nodes[it != m_providerNodeIndices.end() ? it->second : 0];
 }
 
 // Details
 
-bool execq::impl::details::NotifyWorkers(const std::vector<std::unique_ptr<IThreadWorker>>& workers, const bool single)
+execq::IExecutionPool* execq::impl::details::CurrentThreadExecutionPool()
+{
+    return t_currentThreadExecutionPool;
+}
+
+execq::impl::ThreadWorkerOptions execq::impl::details::AdditionalWorkerOptions(const IExecutionPool* executionPool, const ExecutionQueueOptions& options)
+{
+    ThreadWorkerOptions workerOptions = executionPool ? executionPool->additionalWorkerOptions() : ThreadWorkerOptions();
+    workerOptions.threadOptions = options.threadOptions;
+    
+    return workerOptions;
+}
+
+const execq::impl::IThreadWorkerFactory& execq::impl::details::AdditionalWorkerFactory(const IExecutionPool* executionPool)
+{
+    return executionPool ? executionPool->workerFactory() : *IThreadWorkerFactory::defaultFactory();
+}
+
+bool execq::impl::details::NotifyWorkers(const std::vector<std::unique_ptr<IThreadWorker>>& workers, const bool single, const size_t maxCount)
 {
     bool notified = false;
-    for (const auto& worker : workers)
+    const size_t count = std::min(workers.size(), maxCount);
+    for (size_t i = 0; i < count; i++)
     {
-        notified |= worker->notifyWorker();
+        notified |= workers[i]->notifyWorker();
         if (notified && single)
         {
             return true;
@@ -23,19 +23,28 @@
  */
 
 #include "ExecutionStream.h"
+#include "Tracer.h"
+#include "WatchdogScope.h"
 
 execq::impl::ExecutionStream::ExecutionStream(std::shared_ptr<IExecutionPool> executionPool,
                                               const IThreadWorkerFactory& workerFactory,
-                                              std::function<void(const std::atomic_bool& isCanceled)> executee)
+                                              std::function<void(const std::atomic_bool& isCanceled)> executee,
+                                              const ExecutionQueueOptions& options)
 : m_executionPool(executionPool)
 , m_executee(std::move(executee))
-, m_additionalWorker(workerFactory.createWorker(*this))
+, m_latencyHistograms(options.collectLatencyStats ? new LatencyHistograms() : nullptr)
+, m_traceNameId(RegisterTraceName(options.name.empty() ? "ExecutionStream" : options.name))
+, m_usageCounters(options.name.empty() ? "ExecutionStream" : options.name, options.tag)
+, m_accountResourceUsage(options.accountResourceUsage)
+, m_additionalWorker(workerFactory.createWorker(*this, details::AdditionalWorkerOptions(executionPool.get(), options)))
 {
     m_executionPool->addProvider(*this);
+    RegisterMetricsSource(*this);
 }
 
 execq::impl::ExecutionStream::~ExecutionStream()
 {
+    UnregisterMetricsSource(*this);
     stop();
     waitPendingTasks();
     m_executionPool->removeProvider(*this);
@@ -55,6 +64,24 @@ void execq::impl::ExecutionStream::stop()
     m_stopped = true;
 }
 
+execq::LatencyStats execq::impl::ExecutionStream::latencyStats() const
+{
+    return m_latencyHistograms ? m_latencyHistograms->snapshot() : LatencyStats();
+}
+
+void execq::impl::ExecutionStream::resetLatencyStats()
+{
+    if (m_latencyHistograms)
+    {
+        m_latencyHistograms->reset();
+    }
+}
+
+execq::ResourceUsage execq::impl::ExecutionStream::resourceUsage() const
+{
+    return m_usageCounters.snapshot();
+}
+
 // IThreadWorkerPoolTaskProvider
 
 execq::impl::Task execq::impl::ExecutionStream::nextTask()
@@ -66,7 +93,14 @@ execq::impl::Task execq::impl::ExecutionStream::nextTask()
     
     m_tasksRunningCount++;
     return Task([&] {
-        m_executee(m_stopped);
+        {
+            LatencyScope latencyScope(m_latencyHistograms.get(), std::chrono::steady_clock::time_point());
+            UsageScope usageScope(m_accountResourceUsage ? &m_usageCounters : nullptr);
+            ExecutionCountScope countScope(m_executionCounters, false);
+            WatchdogScope watchdogScope(m_traceNameId);
+            TraceScope traceScope(m_traceNameId, this);
+            m_executee(m_stopped);
+        }
         m_tasksRunningCount--;
         
         if (!m_tasksRunningCount)
@@ -76,6 +110,29 @@ execq::impl::Task execq::impl::ExecutionStream::nextTask()
     });
 }
 
+const execq::impl::UsageCounters* execq::impl::ExecutionStream::usageCounters() const
+{
+    return m_accountResourceUsage ? &m_usageCounters : nullptr;
+}
+
+// IMetricsSource
+
+execq::impl::ProviderMetrics execq::impl::ExecutionStream::metrics()
+{
+    ProviderMetrics metrics;
+    metrics.kind = "stream";
+    metrics.resourceUsage = m_usageCounters.snapshot();
+    metrics.hasResourceUsage = m_accountResourceUsage;
+    metrics.name = metrics.resourceUsage.name;
+    metrics.tag = metrics.resourceUsage.tag;
+    metrics.inFlightCount = m_executionCounters.inFlight.load(std::memory_order_relaxed);
+    metrics.completedCount = m_executionCounters.completed.load(std::memory_order_relaxed);
+    metrics.hasLatencyStats = m_latencyHistograms != nullptr;
+    metrics.latencyStats = latencyStats();
+    
+    return metrics;
+}
+
 // Private
 
 void execq::impl::ExecutionStream::waitPendingTasks()
@@ -0,0 +1,248 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "LatencyHistogram.h"
+
+#include <limits>
+#include <algorithm>
+
+namespace
+{
+    // Each power of two is split into 16 buckets: relative precision is 1/16.
+    const uint32_t kSubBucketBits = 4;
+    const uint64_t kSubBucketCount = 1 << kSubBucketBits;
+    
+    // Values up to 2^40 ns (~18 minutes) are distinguished. Longer ones fall into the last bucket.
+    const uint32_t kMaxExponent = 40;
+    const size_t kBucketCount = (kMaxExponent - kSubBucketBits + 1) * kSubBucketCount;
+    
+    thread_local execq::impl::LatencyScope* t_currentLatencyScope = nullptr;
+    
+    uint32_t HighestBit(uint64_t value)
+    {
+        uint32_t bit = 0;
+        while (value >>= 1)
+        {
+            bit++;
+        }
+        
+        return bit;
+    }
+    
+    size_t BucketIndex(const uint64_t value)
+    {
+        if (value < kSubBucketCount)
+        {
+            return static_cast<size_t>(value);
+        }
+        
+        const uint32_t exponent = HighestBit(value);
+        if (exponent >= kMaxExponent)
+        {
+            return kBucketCount - 1;
+        }
+        
+        const uint64_t subBucket = (value >> (exponent - kSubBucketBits)) & (kSubBucketCount - 1);
+        return static_cast<size_t>((exponent - kSubBucketBits + 1) * kSubBucketCount + subBucket);
+    }
+    
+    uint64_t BucketUpperBound(const size_t index)
+    {
+        if (index < kSubBucketCount)
+        {
+            return index;
+        }
+        
+        const uint32_t shift = static_cast<uint32_t>(index / kSubBucketCount) - 1;
+        const uint64_t subBucket = index % kSubBucketCount;
+        return ((kSubBucketCount + subBucket + 1) << shift) - 1;
+    }
+    
+    void UpdateMin(std::atomic<uint64_t>& current, const uint64_t value)
+    {
+        uint64_t currentValue = current.load(std::memory_order_relaxed);
+        while (value < currentValue && !current.compare_exchange_weak(currentValue, value, std::memory_order_relaxed))
+        {}
+    }
+    
+    void UpdateMax(std::atomic<uint64_t>& current, const uint64_t value)
+    {
+        uint64_t currentValue = current.load(std::memory_order_relaxed);
+        while (value > currentValue && !current.compare_exchange_weak(currentValue, value, std::memory_order_relaxed))
+        {}
+    }
+}
+
+// LatencyHistogram
+
+execq::impl::LatencyHistogram::LatencyHistogram()
+: m_bucketCounts(new std::atomic<uint64_t>[kBucketCount])
+{
+    reset();
+}
+
+void execq::impl::LatencyHistogram::record(const std::chrono::nanoseconds value)
+{
+    const uint64_t nanoseconds = static_cast<uint64_t>(std::max<std::chrono::nanoseconds::rep>(value.count(), 0));
+    
+    m_bucketCounts[BucketIndex(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(nanoseconds, std::memory_order_relaxed);
+    UpdateMin(m_min, nanoseconds);
+    UpdateMax(m_max, nanoseconds);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+}
+
+execq::LatencyDistribution execq::impl::LatencyHistogram::snapshot() const
+{
+    LatencyDistribution distribution;
+    distribution.m_bucketCounts.resize(kBucketCount);
+    for (size_t i = 0; i < kBucketCount; i++)
+    {
+        distribution.m_bucketCounts[i] = m_bucketCounts[i].load(std::memory_order_relaxed);
+        distribution.m_count += distribution.m_bucketCounts[i];
+    }
+    
+    // Count is taken from buckets, so percentiles are consistent even if values are recorded meanwhile.
+    if (distribution.m_count)
+    {
+        distribution.m_sum = m_sum.load(std::memory_order_relaxed);
+        distribution.m_min = m_min.load(std::memory_order_relaxed);
+        distribution.m_max = m_max.load(std::memory_order_relaxed);
+    }
+    
+    return distribution;
+}
+
+void execq::impl::LatencyHistogram::reset()
+{
+    m_count = 0;
+    for (size_t i = 0; i < kBucketCount; i++)
+    {
+        m_bucketCounts[i].store(0, std::memory_order_relaxed);
+    }
+    m_sum = 0;
+    m_min = std::numeric_limits<uint64_t>::max();
+    m_max = 0;
+}
+
+// LatencyHistograms
+
+execq::LatencyStats execq::impl::LatencyHistograms::snapshot() const
+{
+    LatencyStats stats;
+    stats.waitTime = waitTime.snapshot();
+    stats.executionTime = executionTime.snapshot();
+    
+    return stats;
+}
+
+void execq::impl::LatencyHistograms::reset()
+{
+    waitTime.reset();
+    executionTime.reset();
+}
+
+// LatencyScope
+
+execq::impl::LatencyScope::LatencyScope(LatencyHistograms* histograms, const std::chrono::steady_clock::time_point pushTime)
+: m_histograms(histograms)
+{
+    if (!m_histograms)
+    {
+        return;
+    }
+    
+    m_parent = t_currentLatencyScope;
+    t_currentLatencyScope = this;
+    m_startTime = std::chrono::steady_clock::now();
+    if (pushTime != std::chrono::steady_clock::time_point())
+    {
+        m_histograms->waitTime.record(m_startTime - pushTime);
+    }
+}
+
+execq::impl::LatencyScope::~LatencyScope()
+{
+    if (!m_histograms)
+    {
+        return;
+    }
+    
+    const std::chrono::steady_clock::duration executionTime = std::chrono::steady_clock::now() - m_startTime;
+    m_histograms->executionTime.record(std::max(executionTime - m_nestedTime, std::chrono::steady_clock::duration(0)));
+    
+    t_currentLatencyScope = m_parent;
+    if (m_parent)
+    {
+        m_parent->m_nestedTime += executionTime;
+    }
+}
+
+// LatencyDistribution
+
+uint64_t execq::LatencyDistribution::count() const
+{
+    return m_count;
+}
+
+std::chrono::nanoseconds execq::LatencyDistribution::min() const
+{
+    return std::chrono::nanoseconds(m_count ? std::min(m_min, m_max) : 0);
+}
+
+std::chrono::nanoseconds execq::LatencyDistribution::max() const
+{
+    return std::chrono::nanoseconds(m_max);
+}
+
+std::chrono::nanoseconds execq::LatencyDistribution::mean() const
+{
+    return std::chrono::nanoseconds(m_count ? m_sum / m_count : 0);
+}
+
+std::chrono::nanoseconds execq::LatencyDistribution::percentile(const double percent) const
+{
+    if (!m_count)
+    {
+        return std::chrono::nanoseconds(0);
+    }
+    
+    const double clampedPercent = std::min(std::max(percent, 0.0), 100.0);
+    const uint64_t rank = std::max<uint64_t>(static_cast<uint64_t>(clampedPercent / 100.0 * m_count + 0.5), 1);
+    
+    uint64_t accumulated = 0;
+    for (size_t i = 0; i < m_bucketCounts.size(); i++)
+    {
+        accumulated += m_bucketCounts[i];
+        if (accumulated >= rank)
+        {
+            // The last bucket has no upper bound: it collects all huge values.
+            const uint64_t upperBound = i + 1 < m_bucketCounts.size() ? BucketUpperBound(i) : m_max;
+            return std::chrono::nanoseconds(std::min(upperBound, m_max));
+        }
+    }
+    
+    return std::chrono::nanoseconds(m_max);
+}
@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "LocalTaskQueue.h"
+
+bool execq::impl::LocalTaskQueue::push(Task&& task, ILocalTaskOwner& owner)
+{
+    MutexLockGuard lock(m_mutex);
+    m_size++;
+    
+    const bool displaced = m_slot.task.valid();
+    if (displaced)
+    {
+        m_tasks.push_back(std::move(m_slot));
+    }
+    m_slot = LocalTask { std::move(task), &owner };
+    
+    return displaced;
+}
+
+execq::impl::Task execq::impl::LocalTaskQueue::pop()
+{
+    if (empty())
+    {
+        return Task();
+    }
+    
+    MutexLockGuard lock(m_mutex);
+    Task task;
+    if (m_slot.task.valid())
+    {
+        task = std::move(m_slot.task);
+    }
+    else if (!m_tasks.empty())
+    {
+        task = std::move(m_tasks.front().task);
+        m_tasks.pop_front();
+    }
+    
+    if (task.valid())
+    {
+        m_size--;
+    }
+    
+    return task;
+}
+
+execq::impl::LocalTask execq::impl::LocalTaskQueue::steal()
+{
+    LocalTask task { Task(), nullptr };
+    if (empty())
+    {
+        return task;
+    }
+    
+    MutexLockGuard lock(m_mutex);
+    if (!m_tasks.empty())
+    {
+        task = std::move(m_tasks.front());
+        m_tasks.pop_front();
+    }
+    else if (m_slot.task.valid())
+    {
+        task = std::move(m_slot);
+    }
+    
+    if (task.task.valid())
+    {
+        m_size--;
+    }
+    
+    return task;
+}
+
+bool execq::impl::LocalTaskQueue::empty() const
+{
+    return !m_size;
+}
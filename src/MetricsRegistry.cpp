@@ -0,0 +1,383 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "MetricsRegistry.h"
+#include "ExecutionPool.h"
+#include "execq/Metrics.h"
+
+#include <mutex>
+#include <cstdio>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+namespace
+{
+    struct MetricsRegistry
+    {
+        std::unordered_map<const execq::IExecutionPool*, uint64_t> pools;
+        std::unordered_map<execq::impl::IMetricsSource*, uint64_t> sources;
+        uint64_t nextId = 0;
+        std::mutex mutex;
+    };
+    
+    MetricsRegistry& GetMetricsRegistry()
+    {
+        // Never destroyed: static pools and queues may unregister while static objects are being destroyed.
+        static MetricsRegistry* s_registry = new MetricsRegistry();
+        return *s_registry;
+    }
+    
+    const std::pair<const char*, double> kQuantiles[] = { { "0.5", 50 }, { "0.9", 90 }, { "0.99", 99 } };
+    
+    double ToSeconds(const std::chrono::nanoseconds duration)
+    {
+        return duration.count() / 1e9;
+    }
+    
+    std::string EscapeLabelValue(const std::string& value)
+    {
+        std::string escaped;
+        escaped.reserve(value.size());
+        for (const char c : value)
+        {
+            switch (c)
+            {
+                case '\\': escaped += "\\\\"; break;
+                case '"': escaped += "\\\""; break;
+                case '\n': escaped += "\\n"; break;
+                default: escaped += c; break;
+            }
+        }
+        
+        return escaped;
+    }
+    
+    std::string PoolLabels(const uint64_t id)
+    {
+        return "pool=\"" + std::to_string(id) + "\"";
+    }
+    
+    std::string ProviderLabels(const execq::impl::ProviderMetrics& metrics)
+    {
+        return std::string("kind=\"") + metrics.kind + "\",name=\"" + EscapeLabelValue(metrics.name)
+        + "\",tag=\"" + EscapeLabelValue(metrics.tag) + "\",id=\"" + std::to_string(metrics.id) + "\"";
+    }
+    
+    void WriteHeader(std::ostream& output, const char* name, const char* type, const char* help)
+    {
+        output << "# HELP " << name << " " << help << "\n";
+        output << "# TYPE " << name << " " << type << "\n";
+    }
+    
+    template <typename V>
+    void WriteSample(std::ostream& output, const std::string& name, const std::string& labels, const V value)
+    {
+        output << name << "{" << labels << "} " << value << "\n";
+    }
+    
+    using PoolEntry = std::pair<uint64_t, execq::ExecutionPoolStats>;
+    using ProviderEntry = execq::impl::ProviderMetrics;
+    
+    template <typename Entry, typename V>
+    void WriteFamily(std::ostream& output, const std::vector<Entry>& entries, const char* name, const char* type, const char* help,
+                     std::function<bool(const Entry& entry, std::string& labels, V& value)> sample)
+    {
+        bool headerWritten = false;
+        for (const Entry& entry : entries)
+        {
+            std::string labels;
+            V value {};
+            if (!sample(entry, labels, value))
+            {
+                continue;
+            }
+            
+            if (!headerWritten)
+            {
+                WriteHeader(output, name, type, help);
+                headerWritten = true;
+            }
+            WriteSample(output, name, labels, value);
+        }
+    }
+    
+    void WriteSummary(std::ostream& output, const std::vector<ProviderEntry>& entries, const char* name, const char* help,
+                      std::function<const execq::LatencyDistribution&(const execq::impl::ProviderMetrics& metrics)> distribution)
+    {
+        bool headerWritten = false;
+        for (const ProviderEntry& entry : entries)
+        {
+            if (!entry.hasLatencyStats)
+            {
+                continue;
+            }
+            
+            if (!headerWritten)
+            {
+                WriteHeader(output, name, "summary", help);
+                headerWritten = true;
+            }
+            
+            const std::string labels = ProviderLabels(entry);
+            const execq::LatencyDistribution& values = distribution(entry);
+            for (const auto& quantile : kQuantiles)
+            {
+                // Quantiles of empty summary are NaN by Prometheus convention.
+                const std::string quantileLabels = labels + ",quantile=\"" + quantile.first + "\"";
+                if (values.count())
+                {
+                    WriteSample(output, name, quantileLabels, ToSeconds(values.percentile(quantile.second)));
+                }
+                else
+                {
+                    WriteSample(output, name, quantileLabels, "NaN");
+                }
+            }
+            WriteSample(output, std::string(name) + "_sum", labels, ToSeconds(values.mean()) * values.count());
+            WriteSample(output, std::string(name) + "_count", labels, values.count());
+        }
+    }
+    
+    void WritePoolMetrics(std::ostream& output, const std::vector<PoolEntry>& pools)
+    {
+        using Sample = std::function<bool(const PoolEntry& entry, std::string& labels, double& value)>;
+        const auto poolSample = [] (std::function<double(const execq::ExecutionPoolStats& stats)> getter) -> Sample {
+            return [getter] (const PoolEntry& entry, std::string& labels, double& value) {
+                labels = PoolLabels(entry.first);
+                value = getter(entry.second);
+                return true;
+            };
+        };
+        const auto workerSum = [] (const execq::ExecutionPoolStats& stats, std::function<double(const execq::WorkerStats& worker)> getter) {
+            double sum = 0;
+            for (const execq::WorkerStats& worker : stats.workers)
+            {
+                sum += getter(worker);
+            }
+            
+            return sum;
+        };
+        
+        WriteFamily<PoolEntry, double>(output, pools, "execq_pool_workers", "gauge", "Number of pool worker slots, including compensating and not started ones.",
+                                       poolSample([] (const execq::ExecutionPoolStats& stats) { return stats.workers.size(); }));
+        WriteFamily<PoolEntry, double>(output, pools, "execq_pool_running_workers", "gauge", "Number of pool workers which threads are running.",
+                                       poolSample([] (const execq::ExecutionPoolStats& stats) { return stats.runningWorkerCount; }));
+        WriteFamily<PoolEntry, double>(output, pools, "execq_pool_parked_workers", "gauge", "Number of pool workers waiting for tasks.",
+                                       poolSample([] (const execq::ExecutionPoolStats& stats) { return stats.parkedWorkerCount; }));
+        WriteFamily<PoolEntry, double>(output, pools, "execq_pool_providers", "gauge", "Number of queues, streams and groups attached to the pool.",
+                                       poolSample([] (const execq::ExecutionPoolStats& stats) { return stats.providerCount; }));
+        WriteFamily<PoolEntry, double>(output, pools, "execq_pool_tasks_total", "counter", "Number of tasks executed by pool workers.",
+                                       poolSample([&] (const execq::ExecutionPoolStats& stats) {
+            return workerSum(stats, [] (const execq::WorkerStats& worker) { return worker.tasksExecuted; });
+        }));
+        WriteFamily<PoolEntry, double>(output, pools, "execq_pool_busy_seconds_total", "counter", "Time pool workers spent executing and looking for tasks.",
+                                       poolSample([&] (const execq::ExecutionPoolStats& stats) {
+            return workerSum(stats, [] (const execq::WorkerStats& worker) { return ToSeconds(worker.busyTime); });
+        }));
+        WriteFamily<PoolEntry, double>(output, pools, "execq_pool_idle_seconds_total", "counter", "Time pool workers spent waiting for tasks.",
+                                       poolSample([&] (const execq::ExecutionPoolStats& stats) {
+            return workerSum(stats, [] (const execq::WorkerStats& worker) { return ToSeconds(worker.idleTime); });
+        }));
+        WriteFamily<PoolEntry, double>(output, pools, "execq_pool_utilization", "gauge", "Share of busy time of active pool workers since the pool is created.",
+                                       poolSample([&] (const execq::ExecutionPoolStats& stats) {
+            const double busy = workerSum(stats, [] (const execq::WorkerStats& worker) { return ToSeconds(worker.busyTime); });
+            const double idle = workerSum(stats, [] (const execq::WorkerStats& worker) { return ToSeconds(worker.idleTime); });
+            return busy + idle > 0 ? busy / (busy + idle) : 0;
+        }));
+    }
+    
+    void WriteProviderMetrics(std::ostream& output, const std::vector<ProviderEntry>& providers)
+    {
+        using Sample = std::function<bool(const ProviderEntry& entry, std::string& labels, double& value)>;
+        const auto providerSample = [] (std::function<double(const execq::impl::ProviderMetrics& metrics)> getter) -> Sample {
+            return [getter] (const ProviderEntry& entry, std::string& labels, double& value) {
+                labels = ProviderLabels(entry);
+                value = getter(entry);
+                return true;
+            };
+        };
+        const auto usageSample = [] (std::function<double(const execq::ResourceUsage& usage)> getter) -> Sample {
+            return [getter] (const ProviderEntry& entry, std::string& labels, double& value) {
+                labels = ProviderLabels(entry);
+                value = getter(entry.resourceUsage);
+                return entry.hasResourceUsage;
+            };
+        };
+        
+        WriteFamily<ProviderEntry, double>(output, providers, "execq_queue_pending", "gauge", "Number of objects waiting in the queue.",
+                                           providerSample([] (const execq::impl::ProviderMetrics& metrics) { return metrics.pendingCount; }));
+        WriteFamily<ProviderEntry, double>(output, providers, "execq_queue_in_flight", "gauge", "Number of objects being processed right now.",
+                                           providerSample([] (const execq::impl::ProviderMetrics& metrics) { return metrics.inFlightCount; }));
+        WriteFamily<ProviderEntry, double>(output, providers, "execq_queue_completed_total", "counter", "Number of processed objects.",
+                                           providerSample([] (const execq::impl::ProviderMetrics& metrics) { return metrics.completedCount; }));
+        WriteFamily<ProviderEntry, double>(output, providers, "execq_queue_canceled_total", "counter", "Number of objects processed after cancel.",
+                                           providerSample([] (const execq::impl::ProviderMetrics& metrics) { return metrics.canceledCount; }));
+        WriteFamily<ProviderEntry, double>(output, providers, "execq_queue_expired_total", "counter", "Number of objects dropped because of expired deadline.",
+                                           providerSample([] (const execq::impl::ProviderMetrics& metrics) { return metrics.expiredCount; }));
+        
+        WriteSummary(output, providers, "execq_queue_wait_seconds", "Time objects wait in the queue before processing.",
+                     [] (const execq::impl::ProviderMetrics& metrics) -> const execq::LatencyDistribution& { return metrics.latencyStats.waitTime; });
+        WriteSummary(output, providers, "execq_queue_execution_seconds", "Time of object processing.",
+                     [] (const execq::impl::ProviderMetrics& metrics) -> const execq::LatencyDistribution& { return metrics.latencyStats.executionTime; });
+        
+        WriteFamily<ProviderEntry, double>(output, providers, "execq_queue_cpu_seconds_total", "counter", "Thread CPU time consumed by object processing.",
+                                           usageSample([] (const execq::ResourceUsage& usage) { return ToSeconds(usage.cpuTime); }));
+        WriteFamily<ProviderEntry, double>(output, providers, "execq_queue_wall_seconds_total", "counter", "Wall time consumed by object processing.",
+                                           usageSample([] (const execq::ResourceUsage& usage) { return ToSeconds(usage.wallTime); }));
+    }
+}
+
+// Registry
+
+void execq::impl::RegisterMetricsPool(const IExecutionPool& pool)
+{
+    MetricsRegistry& registry = GetMetricsRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.pools[&pool] = registry.nextId++;
+}
+
+void execq::impl::UnregisterMetricsPool(const IExecutionPool& pool)
+{
+    MetricsRegistry& registry = GetMetricsRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.pools.erase(&pool);
+}
+
+void execq::impl::RegisterMetricsSource(IMetricsSource& source)
+{
+    MetricsRegistry& registry = GetMetricsRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.sources[&source] = registry.nextId++;
+}
+
+void execq::impl::UnregisterMetricsSource(IMetricsSource& source)
+{
+    MetricsRegistry& registry = GetMetricsRegistry();
+    std::lock_guard<std::mutex> lock(registry.mutex);
+    registry.sources.erase(&source);
+}
+
+std::vector<execq::impl::ProviderMetrics> execq::impl::CollectProviderMetrics()
+{
+    std::vector<ProviderMetrics> providers;
+    {
+        // Metrics are taken under the lock: registered sources can't be destroyed meanwhile.
+        MetricsRegistry& registry = GetMetricsRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto& source : registry.sources)
+        {
+            providers.push_back(source.first->metrics());
+            providers.back().id = source.second;
+        }
+    }
+    
+    std::sort(providers.begin(), providers.end(), [] (const ProviderMetrics& lhs, const ProviderMetrics& rhs) {
+        return lhs.id < rhs.id;
+    });
+    
+    return providers;
+}
+
+// ExecutionCountScope
+
+execq::impl::ExecutionCountScope::ExecutionCountScope(ExecutionCounters& counters, const bool canceled)
+: m_counters(counters)
+{
+    m_counters.inFlight.fetch_add(1, std::memory_order_relaxed);
+    if (canceled)
+    {
+        m_counters.canceled.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+execq::impl::ExecutionCountScope::~ExecutionCountScope()
+{
+    m_counters.completed.fetch_add(1, std::memory_order_relaxed);
+    m_counters.inFlight.fetch_sub(1, std::memory_order_relaxed);
+}
+
+// Public
+
+void execq::ExportPrometheusMetrics(std::ostream& output)
+{
+    std::vector<PoolEntry> pools;
+    {
+        // Snapshots are taken under the lock: registered pools can't be destroyed meanwhile.
+        MetricsRegistry& registry = GetMetricsRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        for (const auto& pool : registry.pools)
+        {
+            pools.emplace_back(pool.second, pool.first->stats());
+        }
+    }
+    std::sort(pools.begin(), pools.end(), [] (const PoolEntry& lhs, const PoolEntry& rhs) {
+        return lhs.first < rhs.first;
+    });
+    const std::vector<ProviderEntry> providers = impl::CollectProviderMetrics();
+    
+    const std::ios_base::fmtflags flags = output.flags();
+    const std::streamsize precision = output.precision();
+    output << std::setprecision(9);
+    WritePoolMetrics(output, pools);
+    WriteProviderMetrics(output, providers);
+    output.flags(flags);
+    output.precision(precision);
+}
+
+std::string execq::GetPrometheusMetrics()
+{
+    std::ostringstream output;
+    ExportPrometheusMetrics(output);
+    return output.str();
+}
+
+bool execq::WritePrometheusMetrics(const std::string& path)
+{
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::out | std::ios::trunc);
+        ExportPrometheusMetrics(file);
+        file.close();
+        if (!file)
+        {
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+    
+    if (std::rename(temporaryPath.c_str(), path.c_str()))
+    {
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+    
+    return true;
+}
@@ -0,0 +1,199 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ProfiledMutex.h"
+#include "execq/LockProfiling.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <iomanip>
+
+namespace
+{
+    struct LockSites
+    {
+        std::map<std::string, std::unique_ptr<execq::impl::LockSiteCounters>> counters;
+        std::mutex mutex;
+    };
+    
+    LockSites& GetLockSites()
+    {
+        // Never destroyed: mutexes of static objects may be used while static objects are being destroyed.
+        static LockSites* s_sites = new LockSites();
+        return *s_sites;
+    }
+    
+    uint64_t ElapsedNs(const std::chrono::steady_clock::time_point start, const std::chrono::steady_clock::time_point end)
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    
+    void UpdateMax(std::atomic<uint64_t>& current, const uint64_t value)
+    {
+        uint64_t currentValue = current.load(std::memory_order_relaxed);
+        while (value > currentValue && !current.compare_exchange_weak(currentValue, value, std::memory_order_relaxed))
+        {}
+    }
+    
+    double ToMicroseconds(const std::chrono::nanoseconds duration)
+    {
+        return duration.count() / 1000.0;
+    }
+}
+
+// ProfiledMutex
+
+execq::impl::LockSiteCounters& execq::impl::GetLockSiteCounters(const char* site)
+{
+    LockSites& sites = GetLockSites();
+    std::lock_guard<std::mutex> lock(sites.mutex);
+    
+    std::unique_ptr<LockSiteCounters>& counters = sites.counters[site];
+    if (!counters)
+    {
+        counters.reset(new LockSiteCounters());
+    }
+    
+    return *counters;
+}
+
+execq::impl::ProfiledMutex::ProfiledMutex(const char* site)
+: m_counters(GetLockSiteCounters(site))
+{}
+
+void execq::impl::ProfiledMutex::lock()
+{
+    if (!m_mutex.try_lock())
+    {
+        const std::chrono::steady_clock::time_point waitStart = std::chrono::steady_clock::now();
+        m_mutex.lock();
+        m_lockTime = std::chrono::steady_clock::now();
+        
+        const uint64_t waitTime = ElapsedNs(waitStart, m_lockTime);
+        m_counters.contendedAcquisitions.fetch_add(1, std::memory_order_relaxed);
+        m_counters.totalWaitTime.fetch_add(waitTime, std::memory_order_relaxed);
+        UpdateMax(m_counters.maxWaitTime, waitTime);
+    }
+    else
+    {
+        m_lockTime = std::chrono::steady_clock::now();
+    }
+    
+    m_counters.acquisitions.fetch_add(1, std::memory_order_relaxed);
+}
+
+bool execq::impl::ProfiledMutex::try_lock()
+{
+    if (!m_mutex.try_lock())
+    {
+        return false;
+    }
+    
+    m_lockTime = std::chrono::steady_clock::now();
+    m_counters.acquisitions.fetch_add(1, std::memory_order_relaxed);
+    
+    return true;
+}
+
+void execq::impl::ProfiledMutex::unlock()
+{
+    const uint64_t holdTime = ElapsedNs(m_lockTime, std::chrono::steady_clock::now());
+    m_counters.totalHoldTime.fetch_add(holdTime, std::memory_order_relaxed);
+    UpdateMax(m_counters.maxHoldTime, holdTime);
+    
+    m_mutex.unlock();
+}
+
+// Public
+
+std::vector<execq::LockSiteStats> execq::GetLockProfile()
+{
+    LockSites& sites = GetLockSites();
+    std::lock_guard<std::mutex> lock(sites.mutex);
+    
+    std::vector<LockSiteStats> profile;
+    for (const auto& site : sites.counters)
+    {
+        const impl::LockSiteCounters& counters = *site.second;
+        
+        LockSiteStats stats;
+        stats.site = site.first;
+        stats.acquisitions = counters.acquisitions.load(std::memory_order_relaxed);
+        stats.contendedAcquisitions = counters.contendedAcquisitions.load(std::memory_order_relaxed);
+        stats.totalWaitTime = std::chrono::nanoseconds(counters.totalWaitTime.load(std::memory_order_relaxed));
+        stats.maxWaitTime = std::chrono::nanoseconds(counters.maxWaitTime.load(std::memory_order_relaxed));
+        stats.totalHoldTime = std::chrono::nanoseconds(counters.totalHoldTime.load(std::memory_order_relaxed));
+        stats.maxHoldTime = std::chrono::nanoseconds(counters.maxHoldTime.load(std::memory_order_relaxed));
+        profile.push_back(stats);
+    }
+    
+    return profile;
+}
+
+void execq::ResetLockProfile()
+{
+    LockSites& sites = GetLockSites();
+    std::lock_guard<std::mutex> lock(sites.mutex);
+    
+    for (const auto& site : sites.counters)
+    {
+        impl::LockSiteCounters& counters = *site.second;
+        counters.acquisitions = 0;
+        counters.contendedAcquisitions = 0;
+        counters.totalWaitTime = 0;
+        counters.maxWaitTime = 0;
+        counters.totalHoldTime = 0;
+        counters.maxHoldTime = 0;
+    }
+}
+
+void execq::DumpLockProfile(std::ostream& output)
+{
+    const std::vector<LockSiteStats> profile = GetLockProfile();
+    if (profile.empty())
+    {
+        output << "No lock profile: execq is built without EXECQ_MUTEX_PROFILING or no mutex is used yet.\n";
+        return;
+    }
+    
+    const std::ios_base::fmtflags flags = output.flags();
+    const std::streamsize precision = output.precision();
+    output << std::left << std::setw(40) << "site" << std::right
+    << std::setw(14) << "acquisitions" << std::setw(12) << "contended"
+    << std::setw(16) << "wait total us" << std::setw(14) << "wait max us"
+    << std::setw(16) << "hold total us" << std::setw(14) << "hold max us" << "\n";
+    
+    output << std::fixed << std::setprecision(1);
+    for (const LockSiteStats& stats : profile)
+    {
+        output << std::left << std::setw(40) << stats.site << std::right
+        << std::setw(14) << stats.acquisitions << std::setw(12) << stats.contendedAcquisitions
+        << std::setw(16) << ToMicroseconds(stats.totalWaitTime) << std::setw(14) << ToMicroseconds(stats.maxWaitTime)
+        << std::setw(16) << ToMicroseconds(stats.totalHoldTime) << std::setw(14) << ToMicroseconds(stats.maxHoldTime) << "\n";
+    }
+    output.flags(flags);
+    output.precision(precision);
+}
@@ -0,0 +1,321 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "Simulation.h"
+
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <algorithm>
+#include <condition_variable>
+
+struct execq::impl::Simulation::Impl
+{
+    class Worker;
+    
+    struct Event
+    {
+        std::chrono::nanoseconds time;
+        uint64_t sequence;
+        std::function<void()> callback;
+        Worker* worker;
+        
+        bool operator>(const Event& other) const
+        {
+            return time != other.time ? time > other.time : sequence > other.sequence;
+        }
+    };
+    
+    class Worker: public IThreadWorker
+    {
+    public:
+        Worker(Impl& simulation, ITaskProvider& provider);
+        ~Worker();
+        
+        virtual bool notifyWorker() final;
+        
+        void consume(const std::chrono::nanoseconds cost);
+        SimulatedWorkerStats stats() const;
+        
+    private:
+        void threadMain();
+        void yield(std::unique_lock<std::mutex>& lock);
+        
+    private:
+        Impl& m_simulation;
+        ITaskProvider& m_provider;
+        
+        // Guarded by the simulation mutex.
+        bool m_parked = true;
+        bool m_notified = false;
+        bool m_shouldQuit = false;
+        SimulatedWorkerStats m_stats;
+        
+        std::thread m_thread;
+    };
+    
+    explicit Impl(const SimulationOptions& options);
+    
+    void schedule(const std::chrono::nanoseconds time, std::function<void()> callback, Worker* worker);
+    void removeEvents(const Worker& worker);
+    
+    static thread_local Worker* currentWorker;
+    
+    const SimulationOptions options;
+    
+    // Worker that runs right now. Null means the thread of 'run'.
+    Worker* runningWorker = nullptr;
+    std::chrono::nanoseconds now { 0 };
+    uint64_t nextSequence = 0;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    std::vector<Worker*> workers;
+    mutable std::mutex mutex;
+    std::condition_variable condition;
+};
+
+// Simulation::Impl
+
+thread_local execq::impl::Simulation::Impl::Worker* execq::impl::Simulation::Impl::currentWorker = nullptr;
+
+execq::impl::Simulation::Impl::Impl(const SimulationOptions& options)
+: options(options)
+{}
+
+void execq::impl::Simulation::Impl::schedule(const std::chrono::nanoseconds time, std::function<void()> callback, Worker* worker)
+{
+    events.push(Event { time, nextSequence++, std::move(callback), worker });
+}
+
+void execq::impl::Simulation::Impl::removeEvents(const Worker& worker)
+{
+    std::vector<Event> remainingEvents;
+    while (!events.empty())
+    {
+        if (events.top().worker != &worker)
+        {
+            remainingEvents.push_back(events.top());
+        }
+        events.pop();
+    }
+    
+    for (Event& event : remainingEvents)
+    {
+        events.push(std::move(event));
+    }
+}
+
+// Simulation::Impl::Worker
+
+execq::impl::Simulation::Impl::Worker::Worker(Impl& simulation, ITaskProvider& provider)
+: m_simulation(simulation)
+, m_provider(provider)
+{
+    m_thread = std::thread(&Worker::threadMain, this);
+}
+
+execq::impl::Simulation::Impl::Worker::~Worker()
+{
+    {
+        // The thread waits to be resumed: resume it for the last time to let it exit.
+        std::unique_lock<std::mutex> lock(m_simulation.mutex);
+        m_simulation.removeEvents(*this);
+        m_simulation.workers.erase(std::remove(m_simulation.workers.begin(), m_simulation.workers.end(), this), m_simulation.workers.end());
+        
+        m_shouldQuit = true;
+        m_simulation.runningWorker = this;
+        m_simulation.condition.notify_all();
+        m_simulation.condition.wait(lock, [this] { return m_simulation.runningWorker != this; });
+    }
+    
+    m_thread.join();
+}
+
+bool execq::impl::Simulation::Impl::Worker::notifyWorker()
+{
+    std::lock_guard<std::mutex> lock(m_simulation.mutex);
+    if (m_notified)
+    {
+        return false;
+    }
+    
+    m_notified = true;
+    if (m_parked)
+    {
+        m_parked = false;
+        m_stats.wakeups++;
+        m_simulation.schedule(m_simulation.now + m_simulation.options.wakeupLatency, nullptr, this);
+    }
+    
+    return true;
+}
+
+void execq::impl::Simulation::Impl::Worker::consume(const std::chrono::nanoseconds cost)
+{
+    if (cost <= std::chrono::nanoseconds(0))
+    {
+        return;
+    }
+    
+    std::unique_lock<std::mutex> lock(m_simulation.mutex);
+    m_stats.busyTime += cost;
+    m_simulation.schedule(m_simulation.now + cost, nullptr, this);
+    yield(lock);
+}
+
+execq::SimulatedWorkerStats execq::impl::Simulation::Impl::Worker::stats() const
+{
+    return m_stats;
+}
+
+void execq::impl::Simulation::Impl::Worker::threadMain()
+{
+    currentWorker = this;
+    
+    std::unique_lock<std::mutex> lock(m_simulation.mutex);
+    m_simulation.condition.wait(lock, [this] { return m_simulation.runningWorker == this; });
+    m_provider.workerStarted();
+    
+    while (!m_shouldQuit)
+    {
+        m_notified = false;
+        lock.unlock();
+        
+        Task task = m_provider.nextTask();
+        if (task.valid())
+        {
+            consume(m_simulation.options.taskOverhead);
+            task();
+            
+            lock.lock();
+            m_stats.tasksExecuted++;
+            continue;
+        }
+        
+        lock.lock();
+        if (m_notified)
+        {
+            continue;
+        }
+        
+        m_parked = true;
+        yield(lock);
+    }
+    
+    m_provider.workerStopped();
+    m_simulation.runningWorker = nullptr;
+    m_simulation.condition.notify_all();
+}
+
+void execq::impl::Simulation::Impl::Worker::yield(std::unique_lock<std::mutex>& lock)
+{
+    m_simulation.runningWorker = nullptr;
+    m_simulation.condition.notify_all();
+    m_simulation.condition.wait(lock, [this] { return m_simulation.runningWorker == this; });
+}
+
+// Simulation
+
+execq::impl::Simulation::Simulation(const SimulationOptions& options)
+: m_impl(new Impl(options))
+{}
+
+execq::impl::Simulation::~Simulation()
+{}
+
+std::unique_ptr<execq::impl::IThreadWorker> execq::impl::Simulation::createWorker(ITaskProvider& provider, const ThreadWorkerOptions&) const
+{
+    std::unique_ptr<Impl::Worker> worker(new Impl::Worker(*m_impl, provider));
+    
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->workers.push_back(worker.get());
+    
+    return worker;
+}
+
+bool execq::impl::Simulation::isSimulated() const
+{
+    return true;
+}
+
+// ISimulation
+
+void execq::impl::Simulation::schedule(const std::chrono::nanoseconds time, std::function<void()> event)
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    m_impl->schedule(time, std::move(event), nullptr);
+}
+
+void execq::impl::Simulation::run()
+{
+    std::unique_lock<std::mutex> lock(m_impl->mutex);
+    while (!m_impl->events.empty())
+    {
+        Impl::Event event = m_impl->events.top();
+        m_impl->events.pop();
+        m_impl->now = std::max(m_impl->now, event.time);
+        
+        if (event.worker)
+        {
+            // The worker runs until it parks or consumes virtual time.
+            m_impl->runningWorker = event.worker;
+            m_impl->condition.notify_all();
+            m_impl->condition.wait(lock, [this] { return !m_impl->runningWorker; });
+        }
+        else
+        {
+            lock.unlock();
+            event.callback();
+            lock.lock();
+        }
+    }
+}
+
+std::chrono::nanoseconds execq::impl::Simulation::now() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    return m_impl->now;
+}
+
+std::vector<execq::SimulatedWorkerStats> execq::impl::Simulation::workerStats() const
+{
+    std::lock_guard<std::mutex> lock(m_impl->mutex);
+    
+    std::vector<SimulatedWorkerStats> stats;
+    for (const Impl::Worker* worker : m_impl->workers)
+    {
+        stats.push_back(worker->stats());
+    }
+    
+    return stats;
+}
+
+void execq::impl::Simulation::Consume(const std::chrono::nanoseconds cost)
+{
+    if (Impl::currentWorker)
+    {
+        Impl::currentWorker->consume(cost);
+    }
+}
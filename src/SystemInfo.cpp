@@ -0,0 +1,322 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "SystemInfo.h"
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#endif
+
+namespace
+{
+    const char* const kNumaOnlineNodesPath = "/sys/devices/system/node/online";
+    const char* const kNumaNodeCpuListPathFormat = "/sys/devices/system/node/node%u/cpulist";
+    
+    const char* const kProcSelfCgroupPath = "/proc/self/cgroup";
+    const char* const kCgroupMountPath = "/sys/fs/cgroup";
+    const char* const kCgroupV1CpuMountPath = "/sys/fs/cgroup/cpu";
+    
+    bool ReadFirstLine(const std::string& path, std::string& line)
+    {
+        std::ifstream file(path);
+        return file && std::getline(file, line);
+    }
+    
+    /**
+     * @brief Returns path of the process cgroup inside hierarchy with specified controller.
+     * @discussion Empty controller means cgroup v2 unified hierarchy.
+     */
+    std::string GetCgroupPath(const std::string& controller)
+    {
+        std::ifstream file(kProcSelfCgroupPath);
+        std::string line;
+        while (std::getline(file, line))
+        {
+            // Line format: "hierarchy-ID:controller-list:cgroup-path"
+            const size_t controllersBegin = line.find(':');
+            const size_t pathBegin = controllersBegin != std::string::npos ? line.find(':', controllersBegin + 1) : std::string::npos;
+            if (pathBegin == std::string::npos)
+            {
+                continue;
+            }
+            
+            std::istringstream controllers(line.substr(controllersBegin + 1, pathBegin - controllersBegin - 1));
+            std::string lineController;
+            bool found = controller.empty() && controllers.peek() == std::char_traits<char>::eof();
+            while (!found && std::getline(controllers, lineController, ','))
+            {
+                found = lineController == controller;
+            }
+            
+            if (found)
+            {
+                return line.substr(pathBegin + 1);
+            }
+        }
+        
+        return std::string();
+    }
+    
+    /**
+     * @brief Reads cgroup file of the process cgroup, falling back to the hierarchy root.
+     * @discussion Inside containers cgroup namespace usually makes the process cgroup the root one.
+     */
+    bool ReadCgroupFile(const std::string& mountPath, const std::string& cgroupPath, const std::string& fileName, std::string& content)
+    {
+        if (!cgroupPath.empty() && cgroupPath != "/" && ReadFirstLine(mountPath + cgroupPath + "/" + fileName, content))
+        {
+            return true;
+        }
+        
+        return ReadFirstLine(mountPath + "/" + fileName, content);
+    }
+}
+
+std::vector<uint32_t> execq::impl::ParseCpuList(const std::string& cpuList)
+{
+    std::vector<uint32_t> cpus;
+    
+    std::istringstream stream(cpuList);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        range.erase(std::remove_if(range.begin(), range.end(), ::isspace), range.end());
+        if (range.empty())
+        {
+            continue;
+        }
+        
+        unsigned long first = 0;
+        unsigned long last = 0;
+        char separator = 0;
+        std::istringstream rangeStream(range);
+        if (!(rangeStream >> first))
+        {
+            return std::vector<uint32_t>();
+        }
+        
+        last = first;
+        if (rangeStream >> separator && (separator != '-' || !(rangeStream >> last) || last < first))
+        {
+            return std::vector<uint32_t>();
+        }
+        
+        for (unsigned long cpu = first; cpu <= last; cpu++)
+        {
+            cpus.push_back(static_cast<uint32_t>(cpu));
+        }
+    }
+    
+    std::sort(cpus.begin(), cpus.end());
+    cpus.erase(std::unique(cpus.begin(), cpus.end()), cpus.end());
+    
+    return cpus;
+}
+
+double execq::impl::ParseCgroupV2CpuMax(const std::string& cpuMax)
+{
+    // Format: "$MAX $PERIOD", where $MAX is "max" when there is no limit.
+    std::istringstream stream(cpuMax);
+    std::string quota;
+    std::string period;
+    if (!(stream >> quota >> period) || quota == "max")
+    {
+        return 0;
+    }
+    
+    return ParseCgroupV1CpuQuota(quota, period);
+}
+
+double execq::impl::ParseCgroupV1CpuQuota(const std::string& quota, const std::string& period)
+{
+    double quotaValue = 0;
+    double periodValue = 0;
+    std::istringstream quotaStream(quota);
+    std::istringstream periodStream(period);
+    if (!(quotaStream >> quotaValue) || !(periodStream >> periodValue) || quotaValue <= 0 || periodValue <= 0)
+    {
+        return 0;
+    }
+    
+    return quotaValue / periodValue;
+}
+
+double execq::impl::GetCgroupCpuLimit()
+{
+    std::string cpuMax;
+    if (ReadCgroupFile(kCgroupMountPath, GetCgroupPath(std::string()), "cpu.max", cpuMax))
+    {
+        return ParseCgroupV2CpuMax(cpuMax);
+    }
+    
+    const std::string cgroupV1Path = GetCgroupPath("cpu");
+    std::string quota;
+    std::string period;
+    if (ReadCgroupFile(kCgroupV1CpuMountPath, cgroupV1Path, "cpu.cfs_quota_us", quota) &&
+        ReadCgroupFile(kCgroupV1CpuMountPath, cgroupV1Path, "cpu.cfs_period_us", period))
+    {
+        return ParseCgroupV1CpuQuota(quota, period);
+    }
+    
+    return 0;
+}
+
+uint32_t execq::impl::GetAffinityCpuCount()
+{
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (sched_getaffinity(0, sizeof(cpuSet), &cpuSet))
+    {
+        return 0;
+    }
+    
+    return static_cast<uint32_t>(CPU_COUNT(&cpuSet));
+#else
+    return 0;
+#endif
+}
+
+std::vector<std::vector<uint32_t>> execq::impl::GetNumaNodeCpus()
+{
+    std::vector<std::vector<uint32_t>> nodes;
+    
+    // Node IDs could be sparse (i.e. '0,2-3' when node is offline or hot-removed), so take them from the online list.
+    std::string onlineNodes;
+    if (!ReadFirstLine(kNumaOnlineNodesPath, onlineNodes))
+    {
+        return nodes;
+    }
+    
+    for (const uint32_t node : ParseCpuList(onlineNodes))
+    {
+        char path[128] = {};
+        snprintf(path, sizeof(path), kNumaNodeCpuListPathFormat, node);
+        
+        std::string cpuList;
+        if (!ReadFirstLine(path, cpuList))
+        {
+            continue;
+        }
+        
+        std::vector<uint32_t> cpus = ParseCpuList(cpuList);
+        if (!cpus.empty())
+        {
+            nodes.push_back(std::move(cpus));
+        }
+    }
+    
+    return nodes;
+}
+
+bool execq::impl::SetCurrentThreadAffinity(const std::vector<uint32_t>& cpus)
+{
+#if defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (const uint32_t cpu : cpus)
+    {
+        if (cpu < CPU_SETSIZE)
+        {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    
+    return !pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet);
+#else
+    return false;
+#endif
+}
+
+int execq::impl::GetCurrentCpu()
+{
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+bool execq::impl::SetCurrentThreadName(const std::string& name)
+{
+#if defined(__linux__)
+    // Linux limits thread name to 16 bytes including terminating zero.
+    return !pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#elif defined(__APPLE__)
+    return !pthread_setname_np(name.c_str());
+#else
+    return false;
+#endif
+}
+
+bool execq::impl::SetCurrentThreadScheduling(const int policy, const int priority)
+{
+#if defined(__unix__) || defined(__APPLE__)
+    sched_param param {};
+    param.sched_priority = priority;
+    return !pthread_setschedparam(pthread_self(), policy, &param);
+#else
+    return false;
+#endif
+}
+
+bool execq::impl::SetCurrentThreadNice(const int niceValue)
+{
+#if defined(__linux__)
+    // On Linux nice value is per-thread attribute, so 'setpriority' with thread id affects only current thread.
+    return !setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), niceValue);
+#else
+    return false;
+#endif
+}
+
+std::chrono::nanoseconds execq::impl::GetCurrentThreadCpuTime()
+{
+#if defined(__unix__) || defined(__APPLE__)
+    timespec time {};
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time))
+    {
+        return std::chrono::nanoseconds(0);
+    }
+    
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+#else
+    return std::chrono::nanoseconds(0);
+#endif
+}
@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "TaskGroup.h"
+#include "Tracer.h"
+#include "WatchdogScope.h"
+
+execq::impl::TaskGroup::TaskGroup(std::shared_ptr<IExecutionPool> executionPool)
+: m_executionPool(executionPool)
+, m_traceNameId(RegisterTraceName("TaskGroup"))
+{
+    m_executionPool->addProvider(*this);
+}
+
+execq::impl::TaskGroup::~TaskGroup()
+{
+    m_cancelTokenProvider.cancel();
+    wait();
+    m_executionPool->removeProvider(*this);
+}
+
+// ITaskGroup
+
+void execq::impl::TaskGroup::run(std::function<void(const std::atomic_bool& isCanceled)> task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_tasks.push(GroupTask { std::move(task), m_cancelTokenProvider.token() });
+        m_pendingCount++;
+        m_hasTask = true;
+    }
+    
+    // If all pool threads are busy, the task will be executed by the thread that waits the group.
+    m_executionPool->notifyOneWorker();
+}
+
+std::vector<std::exception_ptr> execq::impl::TaskGroup::wait()
+{
+    // Only the pool thread may execute other pool tasks; any other thread helps with the group tasks only.
+    const bool helpPool = details::CurrentThreadExecutionPool() == m_executionPool.get();
+    details::WaitHelpingUntil([&] {
+        return !m_pendingCount;
+    }, [&] {
+        return executeNextTask() || (helpPool && m_executionPool->executeNextTask());
+    }, [&] (const std::chrono::microseconds backoff) {
+        // Remaining tasks are being executed on other threads.
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_completeCondition.wait_for(lock, backoff, [&] { return !m_pendingCount || m_hasTask; });
+    });
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<std::exception_ptr> exceptions;
+    exceptions.swap(m_exceptions);
+    
+    return exceptions;
+}
+
+void execq::impl::TaskGroup::cancel()
+{
+    m_cancelTokenProvider.cancelAndRenew();
+}
+
+// ITaskProvider
+
+execq::impl::Task execq::impl::TaskGroup::nextTask()
+{
+    if (!m_hasTask)
+    {
+        return Task();
+    }
+    
+    // Task holds the group 'pending' until it is done, so the group could not be destroyed in the meantime.
+    // The claim is made only while a task is queued (and so is still pending): otherwise 'wait' could see
+    // the count drop to zero and return before the claim, letting the group be destroyed under the returned Task.
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_tasks.empty())
+        {
+            return Task();
+        }
+        m_pendingCount++;
+    }
+    
+    return Task([&] {
+        executeNextTask();
+        finishTask();
+    });
+}
+
+// Private
+
+bool execq::impl::TaskGroup::executeNextTask()
+{
+    GroupTask task;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_tasks.empty())
+        {
+            return false;
+        }
+        
+        task = std::move(m_tasks.front());
+        m_tasks.pop();
+        m_hasTask = !m_tasks.empty();
+    }
+    
+    try
+    {
+        WatchdogScope watchdogScope(m_traceNameId);
+        TraceScope traceScope(m_traceNameId, this);
+        task.function(*task.cancelToken);
+    }
+    catch (...)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_exceptions.push_back(std::current_exception());
+    }
+    
+    finishTask();
+    
+    return true;
+}
+
+void execq::impl::TaskGroup::finishTask()
+{
+    if (--m_pendingCount > 0)
+    {
+        return;
+    }
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_completeCondition.notify_all();
+}
@@ -22,25 +22,128 @@
  * SOFTWARE.
  */
 
+#include <thread>
+#include <iterator>
 #include <algorithm>
 #include "TaskProviderList.h"
 
+execq::impl::TaskProviderList::TaskProviderList(const bool earliestDeadlineFirst)
+: m_taskProviders(new TaskProviders_t())
+, m_earliestDeadlineFirst(earliestDeadlineFirst)
+{
+    m_readerCounts[0] = 0;
+    m_readerCounts[1] = 0;
+}
+
+execq::impl::TaskProviderList::~TaskProviderList()
+{
+    delete m_taskProviders.load();
+}
+
 execq::impl::Task execq::impl::TaskProviderList::nextTask()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_hasProviderDeadlines)
+    {
+        Task task = nextDeadlineTask();
+        if (task.valid())
+        {
+            return task;
+        }
+    }
     
-    const size_t taskProvidersCount = m_taskProviders.size();
-    const auto listEndIt = m_taskProviders.end();
+    const size_t readerSlot = beginRead();
+    const TaskProviders_t& taskProviders = *m_taskProviders.load();
+    const size_t taskProvidersCount = taskProviders.size();
+    const size_t firstTaskProvider = m_currentTaskProvider.load(std::memory_order_relaxed);
     
+    Task task;
     for (size_t i = 0; i < taskProvidersCount; i++)
     {
-        if (m_currentTaskProviderIt == listEndIt)
+        const size_t current = firstTaskProvider + i;
+        task = taskProviders[current % taskProvidersCount]->nextTask();
+        if (task.valid())
         {
-            m_currentTaskProviderIt = m_taskProviders.begin();
+            // Cursor is a hint: racing workers may start from the same provider, but none of them blocks.
+            m_currentTaskProvider.store(current + 1, std::memory_order_relaxed);
+            break;
         }
-        
-        ITaskProvider* const provider = *(m_currentTaskProviderIt++);
-        Task task = provider->nextTask();
+    }
+    endRead(readerSlot);
+    
+    return task;
+}
+
+void execq::impl::TaskProviderList::addProvider(ITaskProvider& provider)
+{
+    MutexLockGuard lock(m_writerMutex);
+    TaskProviders_t* const providers = new TaskProviders_t(*m_taskProviders.load());
+    providers->push_back(&provider);
+    publishProviders(providers);
+}
+
+void execq::impl::TaskProviderList::removeProvider(ITaskProvider& provider)
+{
+    MutexLockGuard lock(m_writerMutex);
+    {
+        MutexLockGuard deadlineLock(m_deadlineMutex);
+        removeProviderDeadline(provider);
+    }
+    
+    const TaskProviders_t& currentProviders = *m_taskProviders.load();
+    if (std::find(currentProviders.begin(), currentProviders.end(), &provider) == currentProviders.end())
+    {
+        return;
+    }
+    
+    TaskProviders_t* const providers = new TaskProviders_t();
+    providers->reserve(currentProviders.size() - 1);
+    std::remove_copy(currentProviders.begin(), currentProviders.end(), std::back_inserter(*providers), &provider);
+    publishProviders(providers);
+}
+
+void execq::impl::TaskProviderList::setProviderDeadline(ITaskProvider& provider, const std::chrono::steady_clock::time_point deadline)
+{
+    if (!m_earliestDeadlineFirst)
+    {
+        return;
+    }
+    
+    MutexLockGuard lock(m_deadlineMutex);
+    removeProviderDeadline(provider);
+    if (deadline != std::chrono::steady_clock::time_point::max())
+    {
+        m_providerDeadlinePositions[&provider] = m_providerDeadlines.emplace(deadline, &provider);
+    }
+    m_hasProviderDeadlines = !m_providerDeadlines.empty();
+}
+
+size_t execq::impl::TaskProviderList::providerCount() const
+{
+    return m_providerCount;
+}
+
+void execq::impl::TaskProviderList::appendProviderUsage(std::vector<ResourceUsage>& usage)
+{
+    const size_t readerSlot = beginRead();
+    for (const ITaskProvider* provider : *m_taskProviders.load())
+    {
+        if (const UsageCounters* counters = provider->usageCounters())
+        {
+            usage.push_back(counters->snapshot());
+        }
+    }
+    endRead(readerSlot);
+}
+
+// Private
+
+execq::impl::Task execq::impl::TaskProviderList::nextDeadlineTask()
+{
+    // Usually the most urgent provider has a task. Others are checked only if it is busy (e.g. serial queue).
+    MutexLockGuard lock(m_deadlineMutex);
+    for (const auto& providerDeadline : m_providerDeadlines)
+    {
+        Task task = providerDeadline.second->nextTask();
         if (task.valid())
         {
             return task;
@@ -50,20 +153,51 @@ execq::impl::Task execq::impl::TaskProviderList::nextTask()
     return Task();
 }
 
-void execq::impl::TaskProviderList::addProvider(ITaskProvider& provider)
+void execq::impl::TaskProviderList::removeProviderDeadline(ITaskProvider& provider)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_taskProviders.push_back(&provider);
-    m_currentTaskProviderIt = m_taskProviders.begin();
+    const auto it = m_providerDeadlinePositions.find(&provider);
+    if (it != m_providerDeadlinePositions.end())
+    {
+        m_providerDeadlines.erase(it->second);
+        m_providerDeadlinePositions.erase(it);
+        m_hasProviderDeadlines = !m_providerDeadlines.empty();
+    }
 }
 
-void execq::impl::TaskProviderList::removeProvider(ITaskProvider& provider)
+void execq::impl::TaskProviderList::publishProviders(const TaskProviders_t* providers)
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    const auto it = std::find(m_taskProviders.begin(), m_taskProviders.end(), &provider);
-    if (it != m_taskProviders.end())
+    const TaskProviders_t* const oldProviders = m_taskProviders.exchange(providers);
+    m_providerCount = providers->size();
+    
+    // Readers that could see old snapshot are registered in the counter of the previous epoch.
+    const uint64_t oldEpoch = m_readEpoch++;
+    std::atomic_size_t& oldReaderCount = m_readerCounts[oldEpoch % 2];
+    while (oldReaderCount > 0)
     {
-        m_taskProviders.erase(it);
-        m_currentTaskProviderIt = m_taskProviders.begin();
+        std::this_thread::yield();
     }
+    
+    delete oldProviders;
+}
+
+size_t execq::impl::TaskProviderList::beginRead()
+{
+    while (true)
+    {
+        const uint64_t epoch = m_readEpoch;
+        const size_t readerSlot = epoch % 2;
+        m_readerCounts[readerSlot]++;
+        if (m_readEpoch == epoch)
+        {
+            return readerSlot;
+        }
+        
+        // Writer switched the epoch meanwhile and may not wait for this counter.
+        m_readerCounts[readerSlot]--;
+    }
+}
+
+void execq::impl::TaskProviderList::endRead(const size_t readerSlot)
+{
+    m_readerCounts[readerSlot]--;
 }
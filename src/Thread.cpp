@@ -0,0 +1,124 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Thread.h"
+
+#include <algorithm>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <pthread.h>
+#include <limits.h>
+#define EXECQ_PTHREAD_THREAD 1
+#endif
+
+#if defined(EXECQ_PTHREAD_THREAD)
+
+struct execq::impl::Thread::Impl
+{
+    pthread_t thread {};
+    bool joinable = false;
+    std::function<void()> function;
+};
+
+namespace
+{
+    void* ThreadStart(void* context)
+    {
+        (*static_cast<std::function<void()>*>(context))();
+        return nullptr;
+    }
+}
+
+execq::impl::Thread::Thread(std::function<void()> function, const size_t stackSize)
+: m_impl(new Impl)
+{
+    m_impl->function = std::move(function);
+    
+    pthread_attr_t attributes;
+    pthread_attr_init(&attributes);
+    if (stackSize)
+    {
+        pthread_attr_setstacksize(&attributes, std::max(stackSize, static_cast<size_t>(PTHREAD_STACK_MIN)));
+    }
+    
+    const int error = pthread_create(&m_impl->thread, &attributes, &ThreadStart, &m_impl->function);
+    pthread_attr_destroy(&attributes);
+    if (error)
+    {
+        throw std::system_error(error, std::generic_category(), "Failed to create thread");
+    }
+    
+    m_impl->joinable = true;
+}
+
+execq::impl::Thread::~Thread()
+{
+    if (joinable())
+    {
+        std::terminate();
+    }
+}
+
+void execq::impl::Thread::join()
+{
+    if (!joinable())
+    {
+        throw std::system_error(std::make_error_code(std::errc::invalid_argument), "Thread is not joinable");
+    }
+    
+    pthread_join(m_impl->thread, nullptr);
+    m_impl->joinable = false;
+}
+
+bool execq::impl::Thread::joinable() const
+{
+    return m_impl->joinable;
+}
+
+#else
+
+struct execq::impl::Thread::Impl
+{
+    std::thread thread;
+};
+
+execq::impl::Thread::Thread(std::function<void()> function, const size_t)
+: m_impl(new Impl { std::thread(std::move(function)) })
+{}
+
+execq::impl::Thread::~Thread() = default;
+
+void execq::impl::Thread::join()
+{
+    m_impl->thread.join();
+}
+
+bool execq::impl::Thread::joinable() const
+{
+    return m_impl->thread.joinable();
+}
+
+#endif
@@ -23,6 +23,79 @@
  */
 
 #include "ThreadWorker.h"
+#include "ProfiledMutex.h"
+#include "Probes.h"
+#include "SystemInfo.h"
+#include "Thread.h"
+#include "Tracer.h"
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <climits>
+#include <ctime>
+#endif
+
+namespace
+{
+    const size_t kStackPageSize = 4096;
+    const size_t kAllocatorWarmUpSize = 256;
+    
+    void PrefaultStack(const size_t size)
+    {
+        volatile char page[kStackPageSize];
+        if (size > sizeof(page))
+        {
+            PrefaultStack(size - sizeof(page));
+        }
+        
+        // Touching the page after recursive call prevents tail-call optimization.
+        page[0] = 0;
+        page[sizeof(page) - 1] = 0;
+    }
+    
+    void WarmUpAllocator()
+    {
+        // Makes allocator to set up its thread-local cache before the first task.
+        std::unique_ptr<volatile char[]> block(new volatile char[kAllocatorWarmUpSize]);
+        block[0] = 0;
+    }
+    
+    // Worker state bits. Notifying running worker is a single atomic RMW, only parking and unparking touch the kernel.
+    const uint32_t kNotified = 1 << 0;
+    const uint32_t kParked = 1 << 1;
+    const uint32_t kRunning = 1 << 2;
+    const uint32_t kShouldQuit = 1 << 3;
+    
+    thread_local std::atomic<uint32_t>* t_currentWorkerState = nullptr;
+    
+    const uint32_t kWakeupTraceNameId = execq::impl::RegisterTraceName("wakeup");
+    
+    void ApplyThreadOptions(const execq::ThreadOptions& options)
+    {
+        if (!options.name.empty())
+        {
+            execq::impl::SetCurrentThreadName(options.name);
+            execq::impl::SetCurrentThreadTraceName(options.name);
+        }
+        
+        if (options.schedulingPolicy >= 0)
+        {
+            execq::impl::SetCurrentThreadScheduling(options.schedulingPolicy, options.schedulingPriority);
+        }
+        
+        if (options.niceValue)
+        {
+            execq::impl::SetCurrentThreadNice(options.niceValue);
+        }
+        
+        if (options.onThreadStart)
+        {
+            options.onThreadStart();
+        }
+    }
+}
 
 namespace execq
 {
@@ -31,23 +104,31 @@ namespace execq
         class ThreadWorker: public IThreadWorker
         {
         public:
-            explicit ThreadWorker(ITaskProvider& provider);
+            ThreadWorker(ITaskProvider& provider, const ThreadWorkerOptions& options);
             virtual ~ThreadWorker();
             
             virtual bool notifyWorker() final;
             
         private:
+            void startThread();
             void threadMain();
             void shutdown();
+            bool park();
+            void unpark();
+            bool waitForStateChange(const uint32_t expected);
+            bool warmUpAndPark();
             
         private:
-            std::atomic_bool m_shouldQuit { false };
-            std::atomic_bool m_checkNextTask { false };
-            std::condition_variable m_condition;
-            std::mutex m_mutex;
-            std::unique_ptr<std::thread> m_thread;
+            std::atomic<uint32_t> m_state { 0 };
+            Mutex m_threadMutex { "ThreadWorker::m_threadMutex" };
+            std::unique_ptr<Thread> m_thread;
+#ifndef __linux__
+            Mutex m_parkMutex { "ThreadWorker::m_parkMutex" };
+            ConditionVariable m_parkCondition;
+#endif
             
             ITaskProvider& m_provider;
+            const ThreadWorkerOptions m_options;
         };
     }
 }
@@ -57,9 +138,9 @@ std::shared_ptr<const execq::impl::IThreadWorkerFactory> execq::impl::IThreadWor
     class ThreadWorkerFactory: public IThreadWorkerFactory
     {
     public:
-        virtual std::unique_ptr<IThreadWorker> createWorker(ITaskProvider& provider) const final
+        virtual std::unique_ptr<IThreadWorker> createWorker(ITaskProvider& provider, const ThreadWorkerOptions& options) const final
         {
-            return std::unique_ptr<IThreadWorker>(new ThreadWorker(provider));
+            return std::unique_ptr<IThreadWorker>(new ThreadWorker(provider, options));
         }
     };
     
@@ -67,13 +148,23 @@ std::shared_ptr<const execq::impl::IThreadWorkerFactory> execq::impl::IThreadWor
     return s_factory;
 }
 
-execq::impl::ThreadWorker::ThreadWorker(ITaskProvider& provider)
+execq::impl::ThreadWorker::ThreadWorker(ITaskProvider& provider, const ThreadWorkerOptions& options)
 : m_provider(provider)
-{}
+, m_options(options)
+{
+    if (m_options.startEagerly)
+    {
+        MutexLockGuard lock(m_threadMutex);
+        m_state |= kRunning;
+        startThread();
+    }
+}
 
 execq::impl::ThreadWorker::~ThreadWorker()
 {
     shutdown();
+    
+    MutexLockGuard lock(m_threadMutex);
     if (m_thread && m_thread->joinable())
     {
         m_thread->join();
@@ -82,58 +173,192 @@ execq::impl::ThreadWorker::~ThreadWorker()
 
 bool execq::impl::ThreadWorker::notifyWorker()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    if (m_checkNextTask)
+    const uint32_t state = m_state.fetch_or(kNotified);
+    if (state & kNotified)
     {
         return false;
     }
     
-    m_checkNextTask = true;
-    if (!m_thread)
+    if (!(state & kRunning))
+    {
+        // Only the notifier that set the flag gets here, the thread is not started or exited because of idle timeout.
+        MutexLockGuard lock(m_threadMutex);
+        if (m_thread)
+        {
+            m_thread->join();
+        }
+        
+        m_state |= kRunning;
+        startThread();
+    }
+    else if (state & kParked)
     {
-        m_thread.reset(new std::thread(&ThreadWorker::threadMain, this));
+        unpark();
     }
     
-    m_condition.notify_one();
-    
     return true;
 }
 
 void execq::impl::ThreadWorker::shutdown()
 {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_shouldQuit = true;
-    m_condition.notify_one();
+    const uint32_t state = m_state.fetch_or(kShouldQuit);
+    if (state & kParked)
+    {
+        unpark();
+    }
+}
+
+void execq::impl::ThreadWorker::startThread()
+{
+    m_thread.reset(new Thread(std::bind(&ThreadWorker::threadMain, this), m_options.threadOptions.stackSize));
 }
 
 void execq::impl::ThreadWorker::threadMain()
 {
+    t_currentWorkerState = &m_state;
+    ApplyThreadOptions(m_options.threadOptions);
+    
+    if (!m_options.cpuAffinity.empty())
+    {
+        SetCurrentThreadAffinity(m_options.cpuAffinity);
+    }
+    
+    m_provider.workerStarted();
+    if (m_options.startEagerly && !warmUpAndPark())
+    {
+        m_provider.workerStopped();
+        return;
+    }
+    
     while (true)
     {
-        if (m_shouldQuit)
+        const uint32_t state = m_state.fetch_and(~kNotified);
+        if (state & kShouldQuit)
         {
             break;
         }
         
-        m_checkNextTask = false;
         Task task = m_provider.nextTask();
         if (task.valid())
         {
+            EXECQ_PROBE1(task_start, this);
             task();
+            EXECQ_PROBE1(task_finish, this);
             continue;
         }
         
-        std::unique_lock<std::mutex> lock(m_mutex);
-        if (m_checkNextTask)
+        if (!park())
+        {
+            break;
+        }
+    }
+    
+    m_provider.workerStopped();
+}
+
+bool execq::impl::ThreadWorker::park()
+{
+    uint32_t state = m_state.load();
+    while (!(state & (kNotified | kShouldQuit)))
+    {
+        // Parked flag is set only if nothing changed since the check, so the notification is never lost.
+        if (!m_state.compare_exchange_weak(state, state | kParked))
         {
             continue;
         }
         
-        if (m_shouldQuit)
+        EXECQ_PROBE1(worker_park, this);
+        const bool timedOut = !waitForStateChange(state | kParked);
+        EXECQ_PROBE1(worker_unpark, this);
+        state = m_state.fetch_and(~kParked) & ~kParked;
+        if (!timedOut)
         {
-            break;
+            TraceInstant(kWakeupTraceNameId);
+        }
+        
+        if (timedOut && !(state & (kNotified | kShouldQuit)))
+        {
+            // Thread exits only if nobody notified it meanwhile. Next notification starts it again.
+            if (m_state.compare_exchange_strong(state, state & ~kRunning))
+            {
+                return false;
+            }
+        }
+    }
+    
+    return !(state & kShouldQuit);
+}
+
+void execq::impl::ThreadWorker::unpark()
+{
+#ifdef __linux__
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_state), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#else
+    {
+        // Locking guarantees the worker either has not checked the state yet or already waits.
+        MutexLockGuard lock(m_parkMutex);
+    }
+    m_parkCondition.notify_one();
+#endif
+}
+
+bool execq::impl::ThreadWorker::waitForStateChange(const uint32_t expected)
+{
+    const std::chrono::milliseconds idleTimeout = m_options.idleTimeout;
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + idleTimeout;
+    
+#ifdef __linux__
+    while (m_state.load() == expected)
+    {
+        timespec timeout = {};
+        if (idleTimeout.count())
+        {
+            const std::chrono::nanoseconds left = deadline - std::chrono::steady_clock::now();
+            if (left.count() <= 0)
+            {
+                return false;
+            }
+            
+            timeout.tv_sec = static_cast<time_t>(left.count() / 1000000000);
+            timeout.tv_nsec = static_cast<long>(left.count() % 1000000000);
         }
         
-        m_condition.wait(lock);
+        // Returns immediately if the state has already changed.
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_state), FUTEX_WAIT_PRIVATE, expected,
+                idleTimeout.count() ? &timeout : nullptr, nullptr, 0);
+    }
+    
+    return true;
+#else
+    MutexUniqueLock lock(m_parkMutex);
+    const auto stateChanged = [this, expected] { return m_state.load() != expected; };
+    if (!idleTimeout.count())
+    {
+        m_parkCondition.wait(lock, stateChanged);
+        return true;
+    }
+    
+    return m_parkCondition.wait_until(lock, deadline, stateChanged);
+#endif
+}
+
+bool execq::impl::ThreadWorker::warmUpAndPark()
+{
+    if (m_options.prefaultStackSize)
+    {
+        PrefaultStack(m_options.prefaultStackSize);
+    }
+    WarmUpAllocator();
+    
+    // Eagerly started thread does not check for tasks until the first notification.
+    return park();
+}
+
+void execq::impl::details::MarkCurrentThreadWorkerNotified()
+{
+    // The worker checks for the next task after the current one anyway, so the flag does not cause extra work.
+    if (t_currentWorkerState)
+    {
+        t_currentWorkerState->fetch_or(kNotified);
     }
 }
@@ -0,0 +1,263 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+namespace
+{
+    const std::chrono::milliseconds kDefaultResolution { 1 };
+    const size_t kDefaultSlotCount = 1024;
+    const size_t kSlotsPerWord = 64;
+}
+
+std::shared_ptr<execq::impl::TimerWheel> execq::impl::TimerWheel::shared()
+{
+    static std::shared_ptr<TimerWheel> s_timerWheel = std::make_shared<TimerWheel>(kDefaultResolution, kDefaultSlotCount);
+    return s_timerWheel;
+}
+
+execq::impl::TimerWheel::TimerWheel(const std::chrono::milliseconds resolution, const size_t slotCount)
+: m_resolution(resolution)
+, m_startTime(Clock::now())
+, m_slots(slotCount)
+, m_occupiedSlots((slotCount + kSlotsPerWord - 1) / kSlotsPerWord)
+{}
+
+execq::impl::TimerWheel::~TimerWheel()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_shouldQuit = true;
+        m_condition.notify_one();
+    }
+    
+    if (m_thread && m_thread->joinable())
+    {
+        m_thread->join();
+    }
+}
+
+execq::impl::TimerWheel::TimerHandle execq::impl::TimerWheel::schedule(const Clock::time_point expiration, std::function<void()> callback)
+{
+    TimerHandle timer = std::make_shared<Timer>();
+    timer->callback = std::move(callback);
+    
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_thread)
+    {
+        m_processedTick = tickForTime(Clock::now());
+        m_thread.reset(new std::thread(&TimerWheel::threadMain, this));
+    }
+    
+    // Timer never fires earlier than requested, so round the tick up.
+    timer->expirationTick = std::max(tickForTime(expiration + m_resolution - Clock::duration(1)), m_processedTick + 1);
+    timer->slot = timer->expirationTick % m_slots.size();
+    
+    TimerList_lt& slot = m_slots[timer->slot];
+    timer->position = slot.insert(slot.end(), timer);
+    markSlot(timer->slot, true);
+    m_timerCount++;
+    
+    // Wake the thread only if it sleeps until a later tick.
+    if (timer->expirationTick < m_wakeupTick)
+    {
+        m_condition.notify_one();
+    }
+    
+    return timer;
+}
+
+bool execq::impl::TimerWheel::cancel(const TimerHandle& timer)
+{
+    if (!timer)
+    {
+        return false;
+    }
+    
+    // Callback is released right away (but outside of the lock): it may own the objects that refer to the timer.
+    std::function<void()> callback;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    switch (timer->state)
+    {
+        case Timer::State::Scheduled:
+            m_slots[timer->slot].erase(timer->position);
+            markSlot(timer->slot, !m_slots[timer->slot].empty());
+            m_timerCount--;
+            timer->state = Timer::State::Done;
+            callback.swap(timer->callback);
+            lock.unlock();
+            return true;
+            
+        case Timer::State::Expired:
+            timer->state = Timer::State::Done;
+            callback.swap(timer->callback);
+            lock.unlock();
+            return true;
+            
+        case Timer::State::Running:
+            // Callback may cancel its own timer: do not wait for itself.
+            if (std::this_thread::get_id() != m_thread->get_id())
+            {
+                m_callbackCondition.wait(lock, [&timer] { return timer->state == Timer::State::Done; });
+            }
+            return false;
+            
+        case Timer::State::Done:
+            return false;
+    }
+    
+    return false;
+}
+
+// Private
+
+void execq::impl::TimerWheel::threadMain()
+{
+    std::vector<TimerHandle> expiredTimers;
+    
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (!m_shouldQuit)
+    {
+        if (!m_timerCount)
+        {
+            m_wakeupTick = std::numeric_limits<uint64_t>::max();
+            m_condition.wait(lock);
+            continue;
+        }
+        
+        // Sleep until the tick of the next occupied slot instead of waking up on each tick.
+        m_wakeupTick = nextOccupiedTick();
+        const Clock::time_point wakeupTime = timeForTick(m_wakeupTick);
+        if (Clock::now() < wakeupTime)
+        {
+            m_condition.wait_until(lock, wakeupTime);
+            continue;
+        }
+        
+        collectExpiredTimers(tickForTime(Clock::now()), expiredTimers);
+        for (const TimerHandle& timer : expiredTimers)
+        {
+            // Timer could be canceled while previous callbacks are executed.
+            if (timer->state != Timer::State::Expired)
+            {
+                continue;
+            }
+            
+            timer->state = Timer::State::Running;
+            lock.unlock();
+            
+            timer->callback();
+            
+            lock.lock();
+            timer->state = Timer::State::Done;
+            timer->callback = nullptr;
+            m_callbackCondition.notify_all();
+        }
+        expiredTimers.clear();
+    }
+}
+
+uint64_t execq::impl::TimerWheel::tickForTime(const Clock::time_point time) const
+{
+    if (time <= m_startTime)
+    {
+        return 0;
+    }
+    
+    return std::chrono::duration_cast<std::chrono::milliseconds>(time - m_startTime).count() / m_resolution.count();
+}
+
+execq::impl::TimerWheel::Clock::time_point execq::impl::TimerWheel::timeForTick(const uint64_t tick) const
+{
+    return m_startTime + m_resolution * tick;
+}
+
+uint64_t execq::impl::TimerWheel::nextOccupiedTick() const
+{
+    // Empty words of the bitmap are skipped entirely.
+    const size_t slotCount = m_slots.size();
+    const size_t firstSlot = (m_processedTick + 1) % slotCount;
+    for (size_t distance = 0; distance < slotCount;)
+    {
+        const size_t slot = (firstSlot + distance) % slotCount;
+        const uint64_t word = m_occupiedSlots[slot / kSlotsPerWord] >> (slot % kSlotsPerWord);
+        if (!word)
+        {
+            distance += std::min(kSlotsPerWord - slot % kSlotsPerWord, slotCount - slot);
+            continue;
+        }
+        
+        if (word & 1)
+        {
+            return m_processedTick + 1 + distance;
+        }
+        distance++;
+    }
+    
+    return m_processedTick + slotCount;
+}
+
+void execq::impl::TimerWheel::markSlot(const size_t slot, const bool occupied)
+{
+    const uint64_t mask = uint64_t(1) << (slot % kSlotsPerWord);
+    if (occupied)
+    {
+        m_occupiedSlots[slot / kSlotsPerWord] |= mask;
+    }
+    else
+    {
+        m_occupiedSlots[slot / kSlotsPerWord] &= ~mask;
+    }
+}
+
+void execq::impl::TimerWheel::collectExpiredTimers(const uint64_t currentTick, std::vector<TimerHandle>& expiredTimers)
+{
+    // If the thread was late for more than one revolution, each slot is visited only once.
+    const uint64_t tickCount = std::min<uint64_t>(currentTick - m_processedTick, m_slots.size());
+    for (uint64_t i = 0; i < tickCount; i++)
+    {
+        TimerList_lt& slot = m_slots[(m_processedTick + 1 + i) % m_slots.size()];
+        for (auto it = slot.begin(); it != slot.end();)
+        {
+            const TimerHandle& timer = *it;
+            if (timer->expirationTick > currentTick)
+            {
+                ++it;
+                continue;
+            }
+            
+            timer->state = Timer::State::Expired;
+            expiredTimers.push_back(timer);
+            it = slot.erase(it);
+            m_timerCount--;
+        }
+        
+        markSlot((m_processedTick + 1 + i) % m_slots.size(), !slot.empty());
+    }
+    
+    m_processedTick = currentTick;
+}
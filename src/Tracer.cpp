@@ -0,0 +1,316 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "Tracer.h"
+#include "execq/Tracing.h"
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <unordered_map>
+
+namespace
+{
+    struct TraceEvent
+    {
+        // Fields are atomic because export may read the slot the owner thread is overwriting right now.
+        std::atomic<uint64_t> timestamp { 0 };
+        std::atomic<uint64_t> provider { 0 };
+        std::atomic<uint32_t> nameId { 0 };
+        std::atomic<char> phase { 0 };
+    };
+    
+    struct ThreadTraceBuffer
+    {
+        ThreadTraceBuffer(const size_t capacity, const uint32_t threadIndex, const std::string& threadName)
+        : events(new TraceEvent[capacity])
+        , capacity(capacity)
+        , threadIndex(threadIndex)
+        , threadName(threadName)
+        {}
+        
+        const std::unique_ptr<TraceEvent[]> events;
+        const size_t capacity;
+        const uint32_t threadIndex;
+        const std::string threadName;
+        
+        // Written only by the owner thread. Events below 'writeIndex - capacity' are overwritten.
+        std::atomic<uint64_t> writeIndex { 0 };
+    };
+    
+    struct TraceState
+    {
+        std::atomic_bool enabled { false };
+        std::atomic<uint64_t> generation { 0 };
+        std::atomic<int64_t> startTime { 0 };
+        
+        size_t eventsPerThread = 0;
+        uint32_t nextThreadIndex = 0;
+        std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+        
+        std::vector<std::string> names;
+        std::unordered_map<std::string, uint32_t> nameIds;
+        
+        std::mutex mutex;
+    };
+    
+    TraceState& GetTraceState()
+    {
+        // Never destroyed: threads may record events while static objects are being destroyed.
+        static TraceState* s_state = new TraceState();
+        return *s_state;
+    }
+    
+    thread_local std::shared_ptr<ThreadTraceBuffer> t_traceBuffer;
+    thread_local uint64_t t_traceBufferGeneration = 0;
+    thread_local std::string t_threadTraceName;
+    
+    int64_t CurrentTimeNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    ThreadTraceBuffer& CurrentThreadBuffer(TraceState& state)
+    {
+        // Buffers of previous tracing session are dropped by 'StartTracing', so the thread creates new one.
+        if (t_traceBuffer && t_traceBufferGeneration == state.generation.load(std::memory_order_acquire))
+        {
+            return *t_traceBuffer;
+        }
+        
+        std::lock_guard<std::mutex> lock(state.mutex);
+        const uint32_t threadIndex = state.nextThreadIndex++;
+        const std::string threadName = t_threadTraceName.empty() ? "thread " + std::to_string(threadIndex) : t_threadTraceName;
+        
+        t_traceBuffer = std::make_shared<ThreadTraceBuffer>(state.eventsPerThread, threadIndex, threadName);
+        t_traceBufferGeneration = state.generation;
+        state.buffers.push_back(t_traceBuffer);
+        
+        return *t_traceBuffer;
+    }
+    
+    void RecordEvent(const char phase, const uint32_t nameId, const void* provider)
+    {
+        TraceState& state = GetTraceState();
+        ThreadTraceBuffer& buffer = CurrentThreadBuffer(state);
+        
+        const uint64_t index = buffer.writeIndex.load(std::memory_order_relaxed);
+        TraceEvent& event = buffer.events[index % buffer.capacity];
+        event.timestamp.store(static_cast<uint64_t>(CurrentTimeNs() - state.startTime.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+        event.provider.store(reinterpret_cast<uintptr_t>(provider), std::memory_order_relaxed);
+        event.nameId.store(nameId, std::memory_order_relaxed);
+        event.phase.store(phase, std::memory_order_relaxed);
+        buffer.writeIndex.store(index + 1, std::memory_order_release);
+    }
+    
+    std::string EscapeJson(const std::string& string)
+    {
+        std::ostringstream escaped;
+        for (const char c : string)
+        {
+            switch (c)
+            {
+                case '"': escaped << "\\\""; break;
+                case '\\': escaped << "\\\\"; break;
+                case '\n': escaped << "\\n"; break;
+                case '\t': escaped << "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20)
+                    {
+                        escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+                    }
+                    else
+                    {
+                        escaped << c;
+                    }
+                    break;
+            }
+        }
+        
+        return escaped.str();
+    }
+    
+    std::string FormatMicroseconds(const uint64_t nanoseconds)
+    {
+        const std::string fraction = std::to_string(nanoseconds % 1000);
+        return std::to_string(nanoseconds / 1000) + "." + std::string(3 - fraction.size(), '0') + fraction;
+    }
+    
+    void ExportBuffer(std::ostream& output, const ThreadTraceBuffer& buffer, const std::vector<std::string>& names, bool& firstEvent)
+    {
+        const auto separator = [&firstEvent] {
+            const char* const result = firstEvent ? "\n" : ",\n";
+            firstEvent = false;
+            return result;
+        };
+        
+        output << separator() << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buffer.threadIndex
+        << R"(,"args":{"name":")" << EscapeJson(buffer.threadName) << R"("}})";
+        
+        const uint64_t endIndex = buffer.writeIndex.load(std::memory_order_acquire);
+        const uint64_t beginIndex = endIndex > buffer.capacity ? endIndex - buffer.capacity : 0;
+        for (uint64_t index = beginIndex; index < endIndex; index++)
+        {
+            const TraceEvent& event = buffer.events[index % buffer.capacity];
+            const uint64_t timestamp = event.timestamp.load(std::memory_order_relaxed);
+            const uint64_t provider = event.provider.load(std::memory_order_relaxed);
+            const uint32_t nameId = event.nameId.load(std::memory_order_relaxed);
+            const char phase = event.phase.load(std::memory_order_relaxed);
+            
+            // The owner could overwrite the slot while it is being read: such events are skipped.
+            const uint64_t currentEndIndex = buffer.writeIndex.load(std::memory_order_acquire);
+            if (index + buffer.capacity <= currentEndIndex || nameId >= names.size())
+            {
+                continue;
+            }
+            
+            output << separator() << R"({"name":")" << EscapeJson(names[nameId]) << R"(","cat":"execq","ph":")" << phase
+            << R"(","ts":)" << FormatMicroseconds(timestamp)
+            << R"(,"pid":1,"tid":)" << buffer.threadIndex;
+            if (phase == 'i')
+            {
+                output << R"(,"s":"t")";
+            }
+            if (provider)
+            {
+                output << R"(,"args":{"id":"0x)" << std::hex << provider << std::dec << R"("})";
+            }
+            output << "}";
+        }
+    }
+}
+
+// Public
+
+void execq::StartTracing(const size_t eventsPerThread)
+{
+    TraceState& state = GetTraceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    
+    state.buffers.clear();
+    state.nextThreadIndex = 0;
+    state.eventsPerThread = std::max<size_t>(eventsPerThread, 1);
+    state.startTime = CurrentTimeNs();
+    state.generation++;
+    state.enabled = true;
+}
+
+void execq::StopTracing()
+{
+    GetTraceState().enabled = false;
+}
+
+void execq::ExportChromeTrace(std::ostream& output)
+{
+    TraceState& state = GetTraceState();
+    
+    std::vector<std::shared_ptr<ThreadTraceBuffer>> buffers;
+    std::vector<std::string> names;
+    {
+        std::lock_guard<std::mutex> lock(state.mutex);
+        buffers = state.buffers;
+        names = state.names;
+    }
+    
+    output << R"({"displayTimeUnit":"ns","traceEvents":[)";
+    bool firstEvent = true;
+    for (const auto& buffer : buffers)
+    {
+        ExportBuffer(output, *buffer, names, firstEvent);
+    }
+    output << "\n]}\n";
+}
+
+// Internal
+
+bool execq::impl::TracingEnabled()
+{
+    return GetTraceState().enabled.load(std::memory_order_relaxed);
+}
+
+uint32_t execq::impl::RegisterTraceName(const std::string& name)
+{
+    TraceState& state = GetTraceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    
+    const auto it = state.nameIds.find(name);
+    if (it != state.nameIds.end())
+    {
+        return it->second;
+    }
+    
+    const uint32_t nameId = static_cast<uint32_t>(state.names.size());
+    state.names.push_back(name);
+    state.nameIds[name] = nameId;
+    
+    return nameId;
+}
+
+std::string execq::impl::TraceName(const uint32_t nameId)
+{
+    TraceState& state = GetTraceState();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    return nameId < state.names.size() ? state.names[nameId] : std::string();
+}
+
+void execq::impl::SetCurrentThreadTraceName(const std::string& name)
+{
+    t_threadTraceName = name;
+}
+
+void execq::impl::TraceInstant(const uint32_t nameId)
+{
+    if (TracingEnabled())
+    {
+        RecordEvent('i', nameId, nullptr);
+    }
+}
+
+// TraceScope
+
+execq::impl::TraceScope::TraceScope(const uint32_t nameId, const void* provider)
+: m_nameId(nameId)
+, m_provider(provider)
+{
+    if (TracingEnabled())
+    {
+        m_enabled = true;
+        RecordEvent('B', m_nameId, m_provider);
+    }
+}
+
+execq::impl::TraceScope::~TraceScope()
+{
+    // End is recorded even if tracing is stopped meanwhile, so begin/end events are always paired.
+    if (m_enabled)
+    {
+        RecordEvent('E', m_nameId, m_provider);
+    }
+}
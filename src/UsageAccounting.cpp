@@ -0,0 +1,91 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "UsageAccounting.h"
+#include "SystemInfo.h"
+
+#include <algorithm>
+
+namespace
+{
+    thread_local execq::impl::UsageScope* t_currentUsageScope = nullptr;
+}
+
+execq::impl::UsageCounters::UsageCounters(const std::string& name, const std::string& tag)
+: m_name(name)
+, m_tag(tag)
+{}
+
+void execq::impl::UsageCounters::record(const std::chrono::nanoseconds cpuTime, const std::chrono::nanoseconds wallTime)
+{
+    m_taskCount.fetch_add(1, std::memory_order_relaxed);
+    m_cpuTime.fetch_add(cpuTime.count(), std::memory_order_relaxed);
+    m_wallTime.fetch_add(wallTime.count(), std::memory_order_relaxed);
+}
+
+execq::ResourceUsage execq::impl::UsageCounters::snapshot() const
+{
+    ResourceUsage usage;
+    usage.name = m_name;
+    usage.tag = m_tag;
+    usage.taskCount = m_taskCount.load(std::memory_order_relaxed);
+    usage.cpuTime = std::chrono::nanoseconds(m_cpuTime.load(std::memory_order_relaxed));
+    usage.wallTime = std::chrono::nanoseconds(m_wallTime.load(std::memory_order_relaxed));
+    
+    return usage;
+}
+
+execq::impl::UsageScope::UsageScope(UsageCounters* counters)
+: m_counters(counters)
+{
+    if (m_counters)
+    {
+        m_parent = t_currentUsageScope;
+        t_currentUsageScope = this;
+        m_cpuStart = GetCurrentThreadCpuTime();
+        m_wallStart = std::chrono::steady_clock::now();
+    }
+}
+
+execq::impl::UsageScope::~UsageScope()
+{
+    if (!m_counters)
+    {
+        return;
+    }
+    
+    const std::chrono::nanoseconds cpuTime = GetCurrentThreadCpuTime() - m_cpuStart;
+    const auto wallTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_wallStart);
+    m_counters->record(std::max(cpuTime - m_nestedCpuTime, std::chrono::nanoseconds(0)),
+                       std::max(wallTime - m_nestedWallTime, std::chrono::nanoseconds(0)));
+    
+    t_currentUsageScope = m_parent;
+    if (m_parent)
+    {
+        m_parent->m_nestedCpuTime += cpuTime;
+        m_parent->m_nestedWallTime += wallTime;
+    }
+}
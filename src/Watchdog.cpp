@@ -0,0 +1,293 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "WatchdogScope.h"
+#include "MetricsRegistry.h"
+#include "Tracer.h"
+#include "execq/Watchdog.h"
+
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <condition_variable>
+
+namespace
+{
+    struct RunningTaskSlot
+    {
+        // Zero start time means the thread runs no task. Start time is cleared while the name is being changed.
+        std::atomic<int64_t> startTime { 0 };
+        std::atomic<uint32_t> nameId { 0 };
+        const std::thread::id threadId = std::this_thread::get_id();
+    };
+    
+    struct WatchdogState
+    {
+        std::atomic_bool enabled { false };
+        
+        std::vector<RunningTaskSlot*> slots;
+        std::mutex slotsMutex;
+        
+        std::thread thread;
+        bool stopRequested = false;
+        std::mutex threadMutex;
+        std::condition_variable threadCondition;
+        
+        std::mutex controlMutex;
+    };
+    
+    WatchdogState& GetWatchdogState()
+    {
+        // Never destroyed: threads may finish tasks while static objects are being destroyed.
+        static WatchdogState* s_state = new WatchdogState();
+        return *s_state;
+    }
+    
+    struct ThreadSlot
+    {
+        ThreadSlot()
+        {
+            WatchdogState& state = GetWatchdogState();
+            std::lock_guard<std::mutex> lock(state.slotsMutex);
+            state.slots.push_back(&slot);
+        }
+        
+        ~ThreadSlot()
+        {
+            WatchdogState& state = GetWatchdogState();
+            std::lock_guard<std::mutex> lock(state.slotsMutex);
+            state.slots.erase(std::remove(state.slots.begin(), state.slots.end(), &slot), state.slots.end());
+        }
+        
+        RunningTaskSlot slot;
+    };
+    
+    thread_local ThreadSlot t_threadSlot;
+    
+    int64_t CurrentTimeNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    void PublishRunningTask(RunningTaskSlot& slot, const uint32_t nameId, const int64_t startTime)
+    {
+        slot.startTime.store(0, std::memory_order_release);
+        slot.nameId.store(nameId, std::memory_order_release);
+        slot.startTime.store(startTime, std::memory_order_release);
+    }
+    
+    struct RunningTask
+    {
+        const RunningTaskSlot* slot;
+        int64_t startTime;
+        uint32_t nameId;
+    };
+    
+    std::vector<RunningTask> RunningTasksStartedBefore(const int64_t time)
+    {
+        std::vector<RunningTask> tasks;
+        
+        WatchdogState& state = GetWatchdogState();
+        std::lock_guard<std::mutex> lock(state.slotsMutex);
+        for (const RunningTaskSlot* slot : state.slots)
+        {
+            const int64_t startTime = slot->startTime.load(std::memory_order_acquire);
+            if (!startTime || startTime > time)
+            {
+                continue;
+            }
+            
+            // The name belongs to the start time only if the start time has not changed meanwhile.
+            const uint32_t nameId = slot->nameId.load(std::memory_order_acquire);
+            if (slot->startTime.load(std::memory_order_acquire) == startTime)
+            {
+                tasks.push_back(RunningTask { slot, startTime, nameId });
+            }
+        }
+        
+        return tasks;
+    }
+    
+    class Watchdog
+    {
+    public:
+        explicit Watchdog(const execq::WatchdogOptions& options)
+        : m_options(options)
+        {}
+        
+        void check()
+        {
+            const int64_t now = CurrentTimeNs();
+            if (m_options.onLongRunningTask)
+            {
+                checkRunningTasks(now);
+            }
+            if (m_options.onStarvedQueue)
+            {
+                checkQueues(std::chrono::steady_clock::now());
+            }
+        }
+        
+    private:
+        void checkRunningTasks(const int64_t now)
+        {
+            const int64_t threshold = std::chrono::duration_cast<std::chrono::nanoseconds>(m_options.longTaskThreshold).count();
+            
+            // Only tasks that are still running are remembered, so the map does not grow.
+            std::unordered_map<const RunningTaskSlot*, int64_t> reportedTasks;
+            for (const RunningTask& task : RunningTasksStartedBefore(now - threshold))
+            {
+                reportedTasks[task.slot] = task.startTime;
+                
+                const auto reported = m_reportedTasks.find(task.slot);
+                if (reported != m_reportedTasks.end() && reported->second == task.startTime)
+                {
+                    continue;
+                }
+                
+                execq::LongRunningTask report;
+                report.name = execq::impl::TraceName(task.nameId);
+                report.duration = std::chrono::nanoseconds(now - task.startTime);
+                report.threadId = task.slot->threadId;
+                m_options.onLongRunningTask(report);
+            }
+            m_reportedTasks.swap(reportedTasks);
+        }
+        
+        void checkQueues(const std::chrono::steady_clock::time_point now)
+        {
+            std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> reportedQueues;
+            for (const execq::impl::ProviderMetrics& metrics : execq::impl::CollectProviderMetrics())
+            {
+                if (!metrics.pendingCount || metrics.waitingSince == std::chrono::steady_clock::time_point::max()
+                    || now - metrics.waitingSince < m_options.starvationThreshold)
+                {
+                    continue;
+                }
+                
+                reportedQueues[metrics.id] = metrics.waitingSince;
+                
+                const auto reported = m_reportedQueues.find(metrics.id);
+                if (reported != m_reportedQueues.end() && reported->second == metrics.waitingSince)
+                {
+                    continue;
+                }
+                
+                execq::StarvedQueue report;
+                report.name = metrics.name;
+                report.tag = metrics.tag;
+                report.pendingCount = metrics.pendingCount;
+                report.starvedFor = std::chrono::duration_cast<std::chrono::nanoseconds>(now - metrics.waitingSince);
+                m_options.onStarvedQueue(report);
+            }
+            m_reportedQueues.swap(reportedQueues);
+        }
+        
+    private:
+        const execq::WatchdogOptions m_options;
+        std::unordered_map<const RunningTaskSlot*, int64_t> m_reportedTasks;
+        std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> m_reportedQueues;
+    };
+    
+    void WatchdogThreadMain(const execq::WatchdogOptions options)
+    {
+        WatchdogState& state = GetWatchdogState();
+        Watchdog watchdog(options);
+        
+        std::unique_lock<std::mutex> lock(state.threadMutex);
+        while (!state.threadCondition.wait_for(lock, options.checkInterval, [&state] { return state.stopRequested; }))
+        {
+            lock.unlock();
+            watchdog.check();
+            lock.lock();
+        }
+    }
+    
+    void StopWatchdogThread(WatchdogState& state)
+    {
+        if (!state.thread.joinable())
+        {
+            return;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(state.threadMutex);
+            state.stopRequested = true;
+        }
+        state.threadCondition.notify_all();
+        state.thread.join();
+        state.enabled = false;
+    }
+}
+
+// WatchdogScope
+
+bool execq::impl::WatchdogEnabled()
+{
+    return GetWatchdogState().enabled.load(std::memory_order_relaxed);
+}
+
+execq::impl::WatchdogScope::WatchdogScope(const uint32_t nameId)
+: m_enabled(WatchdogEnabled())
+{
+    if (m_enabled)
+    {
+        RunningTaskSlot& slot = t_threadSlot.slot;
+        m_previousNameId = slot.nameId.load(std::memory_order_relaxed);
+        m_previousStartTime = slot.startTime.load(std::memory_order_relaxed);
+        PublishRunningTask(slot, nameId, CurrentTimeNs());
+    }
+}
+
+execq::impl::WatchdogScope::~WatchdogScope()
+{
+    if (m_enabled)
+    {
+        PublishRunningTask(t_threadSlot.slot, m_previousNameId, m_previousStartTime);
+    }
+}
+
+// Public
+
+void execq::StartWatchdog(const WatchdogOptions& options)
+{
+    WatchdogState& state = GetWatchdogState();
+    std::lock_guard<std::mutex> lock(state.controlMutex);
+    StopWatchdogThread(state);
+    
+    state.stopRequested = false;
+    state.enabled = true;
+    state.thread = std::thread(WatchdogThreadMain, options);
+}
+
+void execq::StopWatchdog()
+{
+    WatchdogState& state = GetWatchdogState();
+    std::lock_guard<std::mutex> lock(state.controlMutex);
+    StopWatchdogThread(state);
+}
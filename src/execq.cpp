@@ -24,27 +24,59 @@
 
 #include "execq.h"
 #include "ExecutionStream.h"
+#include "TaskGroup.h"
+#include "Simulation.h"
+#include "SystemInfo.h"
+
+#include <cmath>
+#include <algorithm>
 
 namespace
 {
-    uint32_t GetOptimalThreadCount()
+    std::shared_ptr<execq::IExecutionPool> CreateDefaultExecutionPool(const execq::ExecutionPoolOptions& options)
+    {
+        return std::make_shared<execq::impl::ExecutionPool>(options, *execq::impl::IThreadWorkerFactory::defaultFactory());
+    }
+}
+
+uint32_t execq::GetOptimalThreadCount()
+{
+    const uint32_t defaultThreadCount = 4;
+    const uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+    uint32_t threadCount = hardwareThreadCount ? hardwareThreadCount : defaultThreadCount;
+    
+    const uint32_t affinityCpuCount = impl::GetAffinityCpuCount();
+    if (affinityCpuCount)
+    {
+        threadCount = std::min(threadCount, affinityCpuCount);
+    }
+    
+    // Fractional quota (i.e. 2.5 CPUs) still allows all threads to run part of the time, so round it up.
+    const double cgroupCpuLimit = impl::GetCgroupCpuLimit();
+    if (cgroupCpuLimit > 0)
     {
-        
-        const uint32_t defaultThreadCount = 4;
-        const uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
-        
-        return hardwareThreadCount ? hardwareThreadCount : defaultThreadCount;
+        threadCount = std::min(threadCount, static_cast<uint32_t>(std::ceil(cgroupCpuLimit)));
     }
     
-    std::shared_ptr<execq::IExecutionPool> CreateDefaultExecutionPool(const uint32_t threadCount)
+    return std::max<uint32_t>(threadCount, 1);
+}
+
+void execq::ReevaluateThreadCount(const std::shared_ptr<IExecutionPool>& executionPool)
+{
+    if (executionPool)
     {
-        return std::make_shared<execq::impl::ExecutionPool>(threadCount, *execq::impl::IThreadWorkerFactory::defaultFactory());
+        executionPool->reevaluateThreadCount();
     }
 }
 
+execq::ExecutionPoolStats execq::GetExecutionPoolStats(const std::shared_ptr<IExecutionPool>& executionPool)
+{
+    return executionPool ? executionPool->stats() : ExecutionPoolStats();
+}
+
 std::shared_ptr<execq::IExecutionPool> execq::CreateExecutionPool()
 {
-    return CreateDefaultExecutionPool(GetOptimalThreadCount());
+    return CreateExecutionPool(ExecutionPoolOptions());
 }
 
 std::shared_ptr<execq::IExecutionPool> execq::CreateExecutionPool(const uint32_t threadCount)
@@ -53,18 +85,60 @@ std::shared_ptr<execq::IExecutionPool> execq::CreateExecutionPool(const uint32_t
     {
         throw std::runtime_error("Failed to create IExecutionPool: thread count could not be zero.");
     }
-    else if (threadCount == 1)
+    
+    ExecutionPoolOptions options;
+    options.threadCount = threadCount;
+    
+    return CreateExecutionPool(options);
+}
+
+std::shared_ptr<execq::IExecutionPool> execq::CreateExecutionPool(const ExecutionPoolOptions& options)
+{
+    if (options.threadCount == 1)
     {
         throw std::runtime_error("Failed to create IExecutionPool: for single-thread execution use pool-independent serial queue.");
     }
     
-    return CreateDefaultExecutionPool(threadCount);
+    return CreateDefaultExecutionPool(options);
+}
+
+std::unique_ptr<execq::ISimulation> execq::CreateSimulation(const SimulationOptions& options)
+{
+    return std::unique_ptr<impl::Simulation>(new impl::Simulation(options));
+}
+
+std::shared_ptr<execq::IExecutionPool> execq::CreateSimulatedExecutionPool(ISimulation& simulation, const ExecutionPoolOptions& options)
+{
+    const impl::Simulation* simulatedWorkerFactory = dynamic_cast<const impl::Simulation*>(&simulation);
+    if (!simulatedWorkerFactory)
+    {
+        throw std::runtime_error("Failed to create IExecutionPool: simulation must be created with 'CreateSimulation'.");
+    }
+    
+    return std::make_shared<impl::ExecutionPool>(options, *simulatedWorkerFactory);
+}
+
+void execq::ConsumeSimulatedTime(const std::chrono::nanoseconds cost)
+{
+    impl::Simulation::Consume(cost);
 }
 
 std::unique_ptr<execq::IExecutionStream> execq::CreateExecutionStream(std::shared_ptr<IExecutionPool> executionPool,
-                                                                      std::function<void(const std::atomic_bool& isCanceled)> executee)
+                                                                      std::function<void(const std::atomic_bool& isCanceled)> executee,
+                                                                      const ExecutionQueueOptions& options)
 {
     return std::unique_ptr<impl::ExecutionStream>(new impl::ExecutionStream(executionPool,
-                                                                            *impl::IThreadWorkerFactory::defaultFactory(),
-                                                                            std::move(executee)));
+                                                                            impl::details::AdditionalWorkerFactory(executionPool.get()),
+                                                                            std::move(executee),
+                                                                            options));
+}
+
+std::unique_ptr<execq::ITaskGroup> execq::CreateTaskGroup(std::shared_ptr<IExecutionPool> executionPool)
+{
+    if (!executionPool)
+    {
+        throw std::runtime_error("Failed to create ITaskGroup: execution pool could not be null.");
+    }
+    
+    return std::unique_ptr<impl::TaskGroup>(new impl::TaskGroup(executionPool));
 }
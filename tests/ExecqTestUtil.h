@@ -40,12 +40,46 @@ namespace execq
             
             MOCK_METHOD0(notifyOneWorker, bool());
             MOCK_METHOD0(notifyAllWorkers, void());
+            
+            MOCK_METHOD0(executeNextTask, bool());
+            
+            MOCK_METHOD2(setProviderDeadline, void(execq::impl::ITaskProvider& provider, const std::chrono::steady_clock::time_point deadline));
+            
+            virtual execq::impl::ThreadWorkerOptions additionalWorkerOptions() const override
+            {
+                return execq::impl::ThreadWorkerOptions();
+            }
+            
+            virtual const execq::impl::IThreadWorkerFactory& workerFactory() const override
+            {
+                return *execq::impl::IThreadWorkerFactory::defaultFactory();
+            }
+            
+            virtual void reevaluateThreadCount() override
+            {}
+            
+            virtual void beginBlocking() override
+            {}
+            
+            virtual void endBlocking() override
+            {}
+            
+            virtual void pushLocalTask(execq::impl::Task task, execq::impl::ILocalTaskOwner& owner) override
+            {
+                task();
+            }
+            
+            virtual execq::ExecutionPoolStats stats() const override
+            {
+                return execq::ExecutionPoolStats();
+            }
         };
         
         class MockThreadWorkerFactory: public execq::impl::IThreadWorkerFactory
         {
         public:
-            MOCK_CONST_METHOD1(createWorker, std::unique_ptr<execq::impl::IThreadWorker>(execq::impl::ITaskProvider& provider));
+            MOCK_CONST_METHOD2(createWorker, std::unique_ptr<execq::impl::IThreadWorker>(execq::impl::ITaskProvider& provider,
+                                                                                         const execq::impl::ThreadWorkerOptions& options));
         };
         
         class MockThreadWorker: public execq::impl::IThreadWorker
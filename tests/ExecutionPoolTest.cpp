@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "execq.h"
+#include "ExecqTestUtil.h"
+
+#include <future>
+
+using namespace execq::test;
+
+TEST(ExecutionPool, ExecutionPool_BlockingScope_Compensation)
+{
+    execq::ExecutionPoolOptions options;
+    options.threadCount = 2;
+    options.maxCompensatingThreadCount = 2;
+    auto pool = execq::CreateExecutionPool(options);
+    auto group = execq::CreateTaskGroup(pool);
+    
+    std::promise<void> unblock;
+    std::shared_future<void> unblockFuture = unblock.get_future().share();
+    for (size_t i = 0; i < 2; i++)
+    {
+        group->run([unblockFuture] (const std::atomic_bool& isCanceled) {
+            execq::BlockingScope blockingScope;
+            unblockFuture.wait();
+        });
+    }
+    WaitForLongTermJob();
+    
+    // Both pool threads are blocked, but the task is executed by compensating thread
+    std::promise<void> executed;
+    std::future<void> executedFuture = executed.get_future();
+    group->run([&executed] (const std::atomic_bool& isCanceled) {
+        executed.set_value();
+    });
+    EXPECT_EQ(executedFuture.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    
+    unblock.set_value();
+    EXPECT_TRUE(group->wait().empty());
+}
+
+TEST(ExecutionPool, ExecutionPool_BlockingScope_NonPoolThread)
+{
+    // Scope outside of the pool thread does nothing
+    execq::BlockingScope blockingScope;
+    execq::BlockingScope nestedBlockingScope;
+}
+
+TEST(ExecutionPool, ExecutionPool_LocalTask_SameThread)
+{
+    auto pool = execq::CreateExecutionPool(2);
+    
+    std::future<std::thread::id> childThreadFuture;
+    std::unique_ptr<execq::IExecutionQueue<std::thread::id(bool)>> queue;
+    queue = execq::CreateConcurrentExecutionQueue<std::thread::id, bool>(pool, [&] (const std::atomic_bool& isCanceled, bool&& isParent) {
+        if (isParent)
+        {
+            childThreadFuture = queue->push(false);
+        }
+        return std::this_thread::get_id();
+    });
+    
+    // Object pushed from the pool thread is processed next on the same thread
+    const std::thread::id parentThread = queue->push(true).get();
+    EXPECT_EQ(childThreadFuture.get(), parentThread);
+}
+
+TEST(ExecutionPool, ExecutionPool_LocalTask_Steal)
+{
+    auto pool = execq::CreateExecutionPool(2);
+    
+    std::promise<void> childExecuted;
+    std::future<void> childExecutedFuture = childExecuted.get_future();
+    auto queue = execq::CreateConcurrentTaskExecutionQueue(pool);
+    
+    // Parent thread stays busy, so the local task is stolen by other thread
+    std::future<void> parentFuture = queue->push(execq::QueueTask<void>([&] (const std::atomic_bool&) {
+        queue->push(execq::QueueTask<void>([&] (const std::atomic_bool&) {
+            childExecuted.set_value();
+        }));
+        
+        EXPECT_EQ(childExecutedFuture.wait_for(std::chrono::seconds(1)), std::future_status::ready);
+    }));
+    
+    parentFuture.wait();
+}
+
+TEST(ExecutionPool, ExecutionPool_LocalTask_AllWorkersBlocked)
+{
+    auto pool = execq::CreateExecutionPool(2);
+    
+    auto innerQueue = execq::CreateConcurrentExecutionQueue<void, int>(pool, [] (const std::atomic_bool&, int&&) {});
+    auto outerQueue = execq::CreateConcurrentExecutionQueue<void, int>(pool, [&] (const std::atomic_bool&, int&& object) {
+        // Each pool worker blocks on the object it has just pushed: it must be processed by other thread
+        innerQueue->push(std::move(object)).get();
+    });
+    
+    std::future<void> first = outerQueue->push(0);
+    std::future<void> second = outerQueue->push(1);
+    
+    EXPECT_EQ(first.wait_for(kTimeout), std::future_status::ready);
+    EXPECT_EQ(second.wait_for(kTimeout), std::future_status::ready);
+}
+
+TEST(ExecutionPool, ExecutionPool_Stats)
+{
+    auto pool = execq::CreateExecutionPool(2);
+    
+    execq::ExecutionPoolStats stats = execq::GetExecutionPoolStats(pool);
+    EXPECT_EQ(stats.workers.size(), 2);
+    EXPECT_EQ(stats.providerCount, 0);
+    EXPECT_EQ(stats.parkedWorkerCount, 2);
+    
+    // Workers that are not started are neither busy nor idle
+    EXPECT_EQ(stats.runningWorkerCount, 0);
+    for (const execq::WorkerStats& workerStats : stats.workers)
+    {
+        EXPECT_FALSE(workerStats.running);
+        EXPECT_EQ(workerStats.idleTime.count(), 0);
+        EXPECT_EQ(workerStats.busyTime.count(), 0);
+    }
+    
+    auto queue = execq::CreateConcurrentExecutionQueue<void, uint32_t>(pool, [] (const std::atomic_bool& isCanceled, uint32_t&& object) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    });
+    
+    std::vector<std::future<void>> futures;
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        futures.push_back(queue->push(i));
+    }
+    for (auto& future : futures)
+    {
+        future.wait();
+    }
+    WaitForLongTermJob();
+    
+    // All objects are processed and workers went to sleep
+    stats = execq::GetExecutionPoolStats(pool);
+    EXPECT_EQ(stats.providerCount, 1);
+    EXPECT_EQ(stats.parkedWorkerCount, 2);
+    EXPECT_GE(stats.runningWorkerCount, 1);
+    
+    uint64_t tasksExecuted = 0;
+    for (const execq::WorkerStats& workerStats : stats.workers)
+    {
+        tasksExecuted += workerStats.tasksExecuted;
+        EXPECT_GE(workerStats.wakeups, workerStats.usefulWakeups);
+        EXPECT_GT(workerStats.idleTime.count(), 0);
+    }
+    
+    // Queue has its own worker besides the pool ones, so some objects may be processed there
+    EXPECT_GT(tasksExecuted, 0);
+    EXPECT_LE(tasksExecuted, 20);
+    
+    // Only queues created with accounting enabled report their usage
+    EXPECT_TRUE(stats.providerUsage.empty());
+    
+    execq::ExecutionQueueOptions options;
+    options.tag = "accounted";
+    options.accountResourceUsage = true;
+    auto accountedQueue = execq::CreateConcurrentExecutionQueue<void, uint32_t>(pool, [] (const std::atomic_bool& isCanceled, uint32_t&& object) {}, options);
+    accountedQueue->push(0).wait();
+    
+    stats = execq::GetExecutionPoolStats(pool);
+    ASSERT_EQ(stats.providerUsage.size(), 1);
+    EXPECT_EQ(stats.providerUsage[0].tag, "accounted");
+    EXPECT_EQ(stats.providerUsage[0].taskCount, 1);
+}
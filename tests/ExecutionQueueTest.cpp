@@ -23,6 +23,7 @@
  */
 
 #include "execq.h"
+#include "UsageAccounting.h"
 #include "ExecqTestUtil.h"
 
 using namespace execq::test;
@@ -100,6 +101,380 @@ TEST(ExecutionPool, ExecutionQueue_TaskExecutionWhenQueueDestroyed)
     EXPECT_EQ(executeState.second, "qwe");
 }
 
+TEST(ExecutionPool, ExecutionQueue_WaitHelping_NestedTasks)
+{
+    auto pool = execq::CreateExecutionPool(2);
+    
+    // Each outer task pushes nested one into the same queue and waits for it.
+    // There are more outer tasks than threads, so plain 'wait' would block all of them.
+    std::unique_ptr<execq::IExecutionQueue<uint32_t(uint32_t)>> queue;
+    queue = execq::CreateConcurrentExecutionQueue<uint32_t, uint32_t>(pool, [&pool, &queue] (const std::atomic_bool& isCanceled,
+                                                                                            uint32_t&& object) {
+        if (object == 0)
+        {
+            return object;
+        }
+        
+        std::future<uint32_t> nested = queue->push(object - 1);
+        execq::WaitHelping(pool, nested);
+        
+        return nested.get() + 1;
+    });
+    
+    std::vector<std::future<uint32_t>> results;
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        results.push_back(queue->push(3));
+    }
+    
+    for (auto& result : results)
+    {
+        ASSERT_TRUE(result.wait_for(kTimeout) == std::future_status::ready);
+        EXPECT_EQ(result.get(), 3);
+    }
+}
+
+TEST(ExecutionPool, ExecutionQueue_PushAfter)
+{
+    auto pool = execq::CreateExecutionPool();
+    
+    auto queue = execq::CreateConcurrentExecutionQueue<std::chrono::steady_clock::time_point, std::string>(pool, [] (const std::atomic_bool& isCanceled,
+                                                                                                                    std::string&& object) {
+        return std::chrono::steady_clock::now();
+    });
+    
+    const auto pushTime = std::chrono::steady_clock::now();
+    std::future<std::chrono::steady_clock::time_point> result = queue->pushAfter(kLongTermJob, "qwe");
+    
+    ASSERT_TRUE(result.wait_for(kTimeout) == std::future_status::ready);
+    EXPECT_GE(result.get() - pushTime, kLongTermJob);
+}
+
+TEST(ExecutionPool, ExecutionQueue_PushAfter_QueueDestroyed)
+{
+    auto pool = execq::CreateExecutionPool();
+    
+    auto queue = execq::CreateConcurrentExecutionQueue<bool, std::string>(pool, [] (const std::atomic_bool& isCanceled,
+                                                                                      std::string&& object) {
+        return isCanceled.load();
+    });
+    
+    // Delayed object is processed as canceled one immediately when the queue is destroyed
+    std::future<bool> result = queue->pushAfter(std::chrono::hours(1), "qwe");
+    queue.reset();
+    
+    ASSERT_TRUE(result.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    EXPECT_TRUE(result.get());
+}
+
+TEST(ExecutionPool, ExecutionQueue_PushAfter_Cancel)
+{
+    auto pool = execq::CreateExecutionPool();
+    
+    auto queue = execq::CreateConcurrentExecutionQueue<bool, std::string>(pool, [] (const std::atomic_bool& isCanceled,
+                                                                                      std::string&& object) {
+        return isCanceled.load();
+    });
+    
+    // Canceled object is processed immediately as canceled one
+    execq::ScheduledFuture<bool> result = queue->pushAfter(std::chrono::hours(1), "qwe");
+    EXPECT_TRUE(result.cancel());
+    EXPECT_FALSE(result.cancel());
+    
+    ASSERT_TRUE(result.wait_for(kTimeout) == std::future_status::ready);
+    EXPECT_TRUE(result.get());
+    
+    // Handle that outlives the queue does nothing
+    execq::ScheduleHandle handle = queue->pushAfter(std::chrono::hours(1), "asd").handle();
+    queue.reset();
+    EXPECT_FALSE(handle.cancel());
+}
+
+TEST(ExecutionPool, ExecutionQueue_PushPeriodic)
+{
+    auto pool = execq::CreateExecutionPool();
+    
+    auto executedCount = std::make_shared<std::atomic_size_t>(0);
+    auto queue = execq::CreateSerialExecutionQueue<void, std::string>(pool, [executedCount] (const std::atomic_bool& isCanceled,
+                                                                                              std::string&& object) {
+        if (!isCanceled)
+        {
+            (*executedCount)++;
+        }
+    });
+    
+    queue->pushPeriodic(std::chrono::milliseconds(10), "qwe");
+    WaitForLongTermJob();
+    
+    // Canceling the queue stops periodic pushing
+    queue->cancel();
+    const size_t executedBeforeCancel = executedCount->load();
+    EXPECT_GE(executedBeforeCancel, 3);
+    
+    WaitForLongTermJob();
+    EXPECT_LE(executedCount->load(), executedBeforeCancel + 1);
+}
+
+TEST(ExecutionPool, ExecutionQueue_PushPeriodic_CancelHandle)
+{
+    auto pool = execq::CreateExecutionPool();
+    
+    auto executedCount = std::make_shared<std::atomic_size_t>(0);
+    auto queue = execq::CreateSerialExecutionQueue<void, std::string>(pool, [executedCount] (const std::atomic_bool& isCanceled,
+                                                                                              std::string&& object) {
+        (*executedCount)++;
+    });
+    
+    execq::ScheduleHandle handle = queue->pushPeriodic(std::chrono::milliseconds(10), "qwe");
+    execq::ScheduleHandle otherHandle = queue->pushPeriodic(std::chrono::milliseconds(10), "asd");
+    WaitForLongTermJob();
+    
+    // Canceled handles stop periodic pushing
+    handle.cancel();
+    otherHandle.cancel();
+    const size_t executedBeforeCancel = executedCount->load();
+    EXPECT_GE(executedBeforeCancel, 6);
+    
+    WaitForLongTermJob();
+    EXPECT_LE(executedCount->load(), executedBeforeCancel + 2);
+}
+
+TEST(ExecutionPool, ExecutionQueue_PushPeriodic_ObjectFactoryThrows)
+{
+    struct Object
+    {
+        explicit Object(std::shared_ptr<std::atomic_bool> copyThrows)
+        : copyThrows(copyThrows)
+        {}
+        
+        Object(const Object& other)
+        : copyThrows(other.copyThrows)
+        {
+            if (*copyThrows)
+            {
+                throw std::runtime_error("copy failed");
+            }
+        }
+        
+        std::shared_ptr<std::atomic_bool> copyThrows;
+    };
+    
+    auto executedCount = std::make_shared<std::atomic_size_t>(0);
+    auto queue = execq::CreateSerialExecutionQueue<void, Object>([executedCount] (const std::atomic_bool& isCanceled, Object&& object) {
+        (*executedCount)++;
+    });
+    
+    auto copyThrows = std::make_shared<std::atomic_bool>(false);
+    queue->pushPeriodic(std::chrono::milliseconds(10), Object(copyThrows));
+    
+    // Failed ticks are skipped, but pushing continues
+    *copyThrows = true;
+    WaitForLongTermJob();
+    const size_t executedWhileThrowing = executedCount->load();
+    EXPECT_LE(executedWhileThrowing, 1);
+    
+    *copyThrows = false;
+    WaitForLongTermJob();
+    EXPECT_GE(executedCount->load(), executedWhileThrowing + 3);
+}
+
+TEST(ExecutionPool, ExecutionQueue_DispatchSync)
+{
+    std::vector<int> processed;
+    auto queue = execq::CreateSerialExecutionQueue<std::thread::id, int>([&processed] (const std::atomic_bool& isCanceled, int&& object) {
+        if (object == 1)
+        {
+            WaitForLongTermJob();
+        }
+        processed.push_back(object);
+        return std::this_thread::get_id();
+    });
+    
+    // Idle serial queue processes the object on the calling thread
+    EXPECT_EQ(queue->dispatchSync(0), std::this_thread::get_id());
+    
+    // Busy serial queue processes the object in order on its own thread
+    std::future<std::thread::id> busyThread = queue->push(1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_NE(queue->dispatchSync(2), std::this_thread::get_id());
+    EXPECT_EQ(processed, std::vector<int>({ 0, 1, 2 }));
+    busyThread.wait();
+}
+
+TEST(ExecutionPool, ExecutionQueue_LatencyStats)
+{
+    execq::ExecutionQueueOptions options;
+    options.collectLatencyStats = true;
+    auto queue = execq::CreateSerialExecutionQueue<void, int>([] (const std::atomic_bool& isCanceled, int&& object) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }, options);
+    
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 5; i++)
+    {
+        futures.push_back(queue->push(i));
+    }
+    for (auto& future : futures)
+    {
+        future.wait();
+    }
+    
+    // Each object runs at least 2ms, so the last one waits at least 8ms
+    execq::LatencyStats stats = queue->latencyStats();
+    EXPECT_EQ(stats.executionTime.count(), 5);
+    EXPECT_GE(stats.executionTime.percentile(50), std::chrono::milliseconds(2));
+    EXPECT_EQ(stats.waitTime.count(), 5);
+    EXPECT_GE(stats.waitTime.max(), std::chrono::milliseconds(8));
+    
+    queue->resetLatencyStats();
+    EXPECT_EQ(queue->latencyStats().executionTime.count(), 0);
+    EXPECT_EQ(queue->latencyStats().waitTime.count(), 0);
+    
+    // Stats are not collected by default
+    auto defaultQueue = execq::CreateSerialExecutionQueue<void, int>([] (const std::atomic_bool& isCanceled, int&& object) {});
+    defaultQueue->push(0).wait();
+    EXPECT_EQ(defaultQueue->latencyStats().executionTime.count(), 0);
+}
+
+TEST(ExecutionPool, ExecutionQueue_ResourceUsage)
+{
+    execq::ExecutionQueueOptions options;
+    options.name = "Worker";
+    options.tag = "tenant-1";
+    options.accountResourceUsage = true;
+    auto queue = execq::CreateSerialExecutionQueue<void, bool>([] (const std::atomic_bool& isCanceled, bool&& spin) {
+        const auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(5);
+        while (spin && std::chrono::steady_clock::now() < end)
+        {}
+        if (!spin)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }, options);
+    
+    queue->push(true).wait();
+    queue->push(false).wait();
+    
+    // Busy loop consumes CPU, sleep consumes only wall time
+    const execq::ResourceUsage usage = queue->resourceUsage();
+    EXPECT_EQ(usage.name, "Worker");
+    EXPECT_EQ(usage.tag, "tenant-1");
+    EXPECT_EQ(usage.taskCount, 2);
+    EXPECT_GE(usage.wallTime, std::chrono::milliseconds(10));
+#if defined(__unix__) || defined(__APPLE__)
+    EXPECT_GT(usage.cpuTime.count(), 0);
+    EXPECT_LT(usage.cpuTime, usage.wallTime);
+#endif
+    
+    // Usage is not accounted by default
+    auto defaultQueue = execq::CreateSerialExecutionQueue<void, bool>([] (const std::atomic_bool& isCanceled, bool&& object) {});
+    defaultQueue->push(true).wait();
+    EXPECT_EQ(defaultQueue->resourceUsage().name, "ExecutionQueue");
+    EXPECT_EQ(defaultQueue->resourceUsage().taskCount, 0);
+}
+
+TEST(ExecutionPool, ExecutionQueue_ResourceUsage_Nested)
+{
+    execq::impl::UsageCounters outer("outer", "");
+    execq::impl::UsageCounters inner("inner", "");
+    {
+        execq::impl::UsageScope outerScope(&outer);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        {
+            // Task executed while the outer one waits (i.e. helping the pool)
+            execq::impl::UsageScope innerScope(&inner);
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+    
+    // Nested time is accounted only by the nested scope
+    EXPECT_GE(inner.snapshot().wallTime, std::chrono::milliseconds(50));
+    EXPECT_GE(outer.snapshot().wallTime, std::chrono::milliseconds(5));
+    EXPECT_LT(outer.snapshot().wallTime, std::chrono::milliseconds(50));
+    EXPECT_EQ(outer.snapshot().taskCount, 1);
+}
+
+TEST(ExecutionPool, ExecutionQueue_CallerRuns)
+{
+    auto executionPool = std::make_shared<MockExecutionPool>();
+    MockThreadWorkerFactory workerFactory {};
+    
+    execq::impl::ITaskProvider* registeredProvider = nullptr;
+    EXPECT_CALL(*executionPool, addProvider(SaveArgAddress(&registeredProvider)))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(workerFactory, createWorker(::testing::_, ::testing::_))
+    .WillOnce(::testing::Return(::testing::ByMove(std::unique_ptr<MockThreadWorker>(new MockThreadWorker{}))));
+    
+    execq::ExecutionQueueOptions options;
+    options.maxPendingObjects = 1;
+    ::testing::MockFunction<void(const std::atomic_bool&, std::string&&)> mockExecutor;
+    execq::impl::ExecutionQueue<void, std::string> queue(false, executionPool, workerFactory, mockExecutor.AsStdFunction(), options);
+    
+    // The first object waits in the queue
+    EXPECT_CALL(*executionPool, notifyOneWorker())
+    .WillOnce(::testing::Return(true));
+    queue.push("qwe");
+    
+    // The queue is full, so the next object is processed on the calling thread
+    EXPECT_CALL(mockExecutor, Call(CompareWithAtomic(false), CompareRvalue("asd")))
+    .WillOnce(::testing::Return());
+    EXPECT_EQ(queue.push("asd").wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    
+    // Queued object is processed as usual
+    execq::impl::Task task = registeredProvider->nextTask();
+    ASSERT_TRUE(task.valid());
+    EXPECT_CALL(mockExecutor, Call(CompareWithAtomic(false), CompareRvalue("qwe")))
+    .WillOnce(::testing::Return());
+    task();
+    
+    EXPECT_CALL(*executionPool, removeProvider(::testing::_))
+    .WillOnce(::testing::Return());
+}
+
+TEST(ExecutionPool, ExecutionQueue_CallerRuns_SerialBusy)
+{
+    auto executionPool = std::make_shared<MockExecutionPool>();
+    MockThreadWorkerFactory workerFactory {};
+    
+    execq::impl::ITaskProvider* registeredProvider = nullptr;
+    EXPECT_CALL(*executionPool, addProvider(SaveArgAddress(&registeredProvider)))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(workerFactory, createWorker(::testing::_, ::testing::_))
+    .WillOnce(::testing::Return(::testing::ByMove(std::unique_ptr<MockThreadWorker>(new MockThreadWorker{}))));
+    
+    execq::ExecutionQueueOptions options;
+    options.maxPendingObjects = 1;
+    ::testing::MockFunction<void(const std::atomic_bool&, std::string&&)> mockExecutor;
+    execq::impl::ExecutionQueue<void, std::string> queue(true, executionPool, workerFactory, mockExecutor.AsStdFunction(), options);
+    
+    EXPECT_CALL(*executionPool, notifyOneWorker())
+    .WillOnce(::testing::Return(true));
+    queue.push("qwe");
+    
+    // The queue is full, but is being processed by other task: the object is queued without blocking
+    execq::impl::Task task = registeredProvider->nextTask();
+    ASSERT_TRUE(task.valid());
+    std::future<void> future = queue.push("asd");
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::timeout);
+    
+    ::testing::InSequence sequence;
+    EXPECT_CALL(mockExecutor, Call(CompareWithAtomic(false), CompareRvalue("qwe")))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(*executionPool, notifyOneWorker())
+    .WillOnce(::testing::Return(true));
+    task();
+    
+    task = registeredProvider->nextTask();
+    ASSERT_TRUE(task.valid());
+    EXPECT_CALL(mockExecutor, Call(CompareWithAtomic(false), CompareRvalue("asd")))
+    .WillOnce(::testing::Return());
+    task();
+    EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    
+    EXPECT_CALL(*executionPool, removeProvider(::testing::_))
+    .WillOnce(::testing::Return());
+}
+
 TEST(ExecutionPool, ExecutionQueue_ExecutionPool_Concurrent)
 {
     auto executionPool = std::make_shared<MockExecutionPool>();
@@ -114,7 +489,7 @@ TEST(ExecutionPool, ExecutionQueue_ExecutionPool_Concurrent)
     // Queue also creates additional single thread worker for its own needs
     std::unique_ptr<MockThreadWorker> additionalWorkerPtr(new MockThreadWorker{});
     MockThreadWorker& additionalWorker = *additionalWorkerPtr;
-    EXPECT_CALL(workerFactory, createWorker(::testing::_))
+    EXPECT_CALL(workerFactory, createWorker(::testing::_, ::testing::_))
     .WillOnce(::testing::Return(::testing::ByMove(std::move(additionalWorkerPtr))));
     
     
@@ -174,7 +549,7 @@ TEST(ExecutionPool, ExecutionQueue_ExecutionPool_Serial)
     // Queue also creates additional single thread worker for its own needs
     std::unique_ptr<MockThreadWorker> additionalWorkerPtr(new MockThreadWorker{});
     MockThreadWorker& additionalWorker = *additionalWorkerPtr;
-    EXPECT_CALL(workerFactory, createWorker(::testing::_))
+    EXPECT_CALL(workerFactory, createWorker(::testing::_, ::testing::_))
     .WillOnce(::testing::Return(::testing::ByMove(std::move(additionalWorkerPtr))));
     
     
@@ -226,6 +601,56 @@ TEST(ExecutionPool, ExecutionQueue_ExecutionPool_Serial)
     .WillOnce(::testing::Return());
 }
 
+TEST(ExecutionPool, ExecutionQueue_ExecutionPool_SerialBatch)
+{
+    auto executionPool = std::make_shared<MockExecutionPool>();
+    MockThreadWorkerFactory workerFactory {};
+    
+    execq::impl::ITaskProvider* registeredProvider = nullptr;
+    EXPECT_CALL(*executionPool, addProvider(SaveArgAddress(&registeredProvider)))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(workerFactory, createWorker(::testing::_, ::testing::_))
+    .WillOnce(::testing::Return(::testing::ByMove(std::unique_ptr<MockThreadWorker>(new MockThreadWorker{}))));
+    
+    execq::ExecutionQueueOptions options;
+    options.serialBatchSize = 2;
+    options.serialBatchDuration = std::chrono::microseconds(0);
+    ::testing::MockFunction<void(const std::atomic_bool&, std::string&&)> mockExecutor;
+    execq::impl::ExecutionQueue<void, std::string> queue(true, executionPool, workerFactory, mockExecutor.AsStdFunction(), options);
+    ASSERT_NE(registeredProvider, nullptr);
+    
+    EXPECT_CALL(*executionPool, notifyOneWorker())
+    .WillOnce(::testing::Return(true));
+    queue.push("1");
+    queue.push("2");
+    queue.push("3");
+    
+    // Single task processes the batch of objects in a row
+    execq::impl::Task task = registeredProvider->nextTask();
+    ASSERT_TRUE(task.valid());
+    ::testing::InSequence sequence;
+    EXPECT_CALL(mockExecutor, Call(CompareWithAtomic(false), CompareRvalue("1")))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(mockExecutor, Call(CompareWithAtomic(false), CompareRvalue("2")))
+    .WillOnce(::testing::Return());
+    
+    // When the batch is over, other workers are notified about the rest of objects
+    EXPECT_CALL(*executionPool, notifyOneWorker())
+    .WillOnce(::testing::Return(true));
+    task();
+    
+    task = registeredProvider->nextTask();
+    ASSERT_TRUE(task.valid());
+    EXPECT_CALL(mockExecutor, Call(CompareWithAtomic(false), CompareRvalue("3")))
+    .WillOnce(::testing::Return());
+    task();
+    
+    EXPECT_FALSE(registeredProvider->nextTask().valid());
+    
+    EXPECT_CALL(*executionPool, removeProvider(::testing::_))
+    .WillOnce(::testing::Return());
+}
+
 TEST(ExecutionPool, ExecutionQueue_Cancelability)
 {
     auto executionPool = std::make_shared<MockExecutionPool>();
@@ -244,7 +669,7 @@ TEST(ExecutionPool, ExecutionQueue_Cancelability)
     
     // Queue also creates additional single thread worker for its own needs
     std::unique_ptr<MockThreadWorker> additionalWorkerPtr(new MockThreadWorker{});
-    EXPECT_CALL(workerFactory, createWorker(::testing::_))
+    EXPECT_CALL(workerFactory, createWorker(::testing::_, ::testing::_))
     .WillOnce(::testing::Return(::testing::ByMove(std::move(additionalWorkerPtr))));
     
     
@@ -276,6 +701,66 @@ TEST(ExecutionPool, ExecutionQueue_Cancelability)
     task();
     
     
+    //  Queue must 'unregister' itself in ExecutionPool when destroyed
+    EXPECT_CALL(*executionPool, removeProvider(::testing::_))
+    .WillOnce(::testing::Return());
+}
+
+TEST(ExecutionPool, ExecutionQueue_Deadline)
+{
+    auto executionPool = std::make_shared<MockExecutionPool>();
+    MockThreadWorkerFactory workerFactory {};
+    
+    // Assume worker pool always has free workers
+    EXPECT_CALL(*executionPool, notifyOneWorker())
+    .WillRepeatedly(::testing::Return(true));
+    
+    
+    //  Queue must 'register' itself in ExecutionPool when created
+    execq::impl::ITaskProvider* registeredProvider = nullptr;
+    EXPECT_CALL(*executionPool, addProvider(SaveArgAddress(&registeredProvider)))
+    .WillOnce(::testing::Return());
+    
+    
+    // Queue also creates additional single thread worker for its own needs
+    std::unique_ptr<MockThreadWorker> additionalWorkerPtr(new MockThreadWorker{});
+    EXPECT_CALL(workerFactory, createWorker(::testing::_, ::testing::_))
+    .WillOnce(::testing::Return(::testing::ByMove(std::move(additionalWorkerPtr))));
+    
+    
+    // Create queue with mock execution function
+    ::testing::MockFunction<void(const std::atomic_bool&, std::string&&)> mockExecutor;
+    execq::impl::ExecutionQueue<void, std::string> queue(false, executionPool, workerFactory, mockExecutor.AsStdFunction());
+    ASSERT_NE(registeredProvider, nullptr);
+    
+    
+    // Queue reports deadline of its next object to the pool
+    const auto now = std::chrono::steady_clock::now();
+    ::testing::InSequence sequence;
+    EXPECT_CALL(*executionPool, setProviderDeadline(::testing::_, now - std::chrono::milliseconds(1)))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(*executionPool, setProviderDeadline(::testing::_, now + std::chrono::hours(1)))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(*executionPool, setProviderDeadline(::testing::_, std::chrono::steady_clock::time_point::max()))
+    .WillOnce(::testing::Return());
+    
+    
+    // Object with expired deadline is dropped, the next one is processed instead
+    std::future<void> expired = queue.pushWithDeadline(now - std::chrono::milliseconds(1), "qwe");
+    std::future<void> actual = queue.pushWithDeadline(now + std::chrono::hours(1), "asd");
+    
+    EXPECT_CALL(mockExecutor, Call(::testing::_, CompareRvalue("asd")))
+    .WillOnce(::testing::Return());
+    
+    execq::impl::Task task = registeredProvider->nextTask();
+    ASSERT_TRUE(task.valid());
+    task();
+    
+    EXPECT_THROW(expired.get(), execq::DeadlineExpiredError);
+    EXPECT_NO_THROW(actual.get());
+    EXPECT_EQ(queue.expiredCount(), 1);
+    
+    
     //  Queue must 'unregister' itself in ExecutionPool when destroyed
     EXPECT_CALL(*executionPool, removeProvider(::testing::_))
     .WillOnce(::testing::Return());
@@ -76,7 +76,7 @@ TEST(ExecutionPool, ExecutionStream_WorkerPool)
     // Strean also creates additional single thread worker for its own needs
     std::unique_ptr<MockThreadWorker> additionalWorkerPtr(new MockThreadWorker{});
     MockThreadWorker& additionalWorker = *additionalWorkerPtr;
-    EXPECT_CALL(workerFactory, createWorker(::testing::_))
+    EXPECT_CALL(workerFactory, createWorker(::testing::_, ::testing::_))
     .WillOnce(::testing::Return(::testing::ByMove(std::move(additionalWorkerPtr))));
     
     
@@ -113,3 +113,24 @@ TEST(ExecutionPool, ExecutionStream_WorkerPool)
     EXPECT_CALL(*executionPool, removeProvider(::testing::_))
     .WillOnce(::testing::Return());
 }
+
+TEST(ExecutionPool, ExecutionStream_LatencyStats)
+{
+    auto pool = execq::CreateExecutionPool(2);
+    
+    execq::ExecutionQueueOptions options;
+    options.collectLatencyStats = true;
+    auto stream = execq::CreateExecutionStream(pool, [] (const std::atomic_bool& isCanceled) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }, options);
+    
+    stream->start();
+    WaitForLongTermJob();
+    stream->stop();
+    
+    // Stream records only execution time: it has no objects waiting in the queue
+    const execq::LatencyStats stats = stream->latencyStats();
+    EXPECT_GT(stats.executionTime.count(), 0);
+    EXPECT_GE(stats.executionTime.min(), std::chrono::milliseconds(1));
+    EXPECT_EQ(stats.waitTime.count(), 0);
+}
@@ -0,0 +1,86 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "LatencyHistogram.h"
+#include "ExecqTestUtil.h"
+
+TEST(ExecutionPool, LatencyHistogram_Percentiles)
+{
+    execq::impl::LatencyHistogram histogram;
+    for (int i = 1; i <= 1000; i++)
+    {
+        histogram.record(std::chrono::microseconds(i));
+    }
+    
+    const execq::LatencyDistribution distribution = histogram.snapshot();
+    EXPECT_EQ(distribution.count(), 1000);
+    EXPECT_EQ(distribution.min(), std::chrono::microseconds(1));
+    EXPECT_EQ(distribution.max(), std::chrono::microseconds(1000));
+    EXPECT_EQ(distribution.mean(), std::chrono::nanoseconds(500500));
+    
+    // Percentiles are precise up to the bucket width (1/16 of the value)
+    EXPECT_NEAR(distribution.percentile(50).count(), 500000, 500000 / 16);
+    EXPECT_NEAR(distribution.percentile(99).count(), 990000, 990000 / 16);
+    EXPECT_EQ(distribution.percentile(100), std::chrono::microseconds(1000));
+    
+    histogram.reset();
+    EXPECT_EQ(histogram.snapshot().count(), 0);
+    EXPECT_EQ(histogram.snapshot().percentile(50).count(), 0);
+}
+
+TEST(ExecutionPool, LatencyHistogram_SmallAndHugeValues)
+{
+    execq::impl::LatencyHistogram histogram;
+    histogram.record(std::chrono::nanoseconds(-5));
+    histogram.record(std::chrono::nanoseconds(7));
+    histogram.record(std::chrono::hours(1));
+    
+    // Small values are exact, values out of the range fall into the last bucket
+    const execq::LatencyDistribution distribution = histogram.snapshot();
+    EXPECT_EQ(distribution.count(), 3);
+    EXPECT_EQ(distribution.min().count(), 0);
+    EXPECT_EQ(distribution.percentile(50).count(), 7);
+    EXPECT_EQ(distribution.percentile(100), std::chrono::hours(1));
+}
+
+TEST(ExecutionPool, LatencyScope_Nested)
+{
+    execq::impl::LatencyHistograms outer;
+    execq::impl::LatencyHistograms inner;
+    {
+        execq::impl::LatencyScope outerScope(&outer, std::chrono::steady_clock::time_point());
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        {
+            // Task executed while the outer one waits (i.e. helping the pool)
+            execq::impl::LatencyScope innerScope(&inner, std::chrono::steady_clock::time_point());
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+    
+    // Nested execution time is not counted twice
+    EXPECT_GE(inner.executionTime.snapshot().max(), std::chrono::milliseconds(50));
+    EXPECT_GE(outer.executionTime.snapshot().max(), std::chrono::milliseconds(5));
+    EXPECT_LT(outer.executionTime.snapshot().max(), std::chrono::milliseconds(50));
+}
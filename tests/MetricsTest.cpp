@@ -0,0 +1,93 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "execq.h"
+#include "ExecqTestUtil.h"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+TEST(ExecutionPool, Metrics_PrometheusText)
+{
+    auto pool = execq::CreateExecutionPool(2);
+    
+    execq::ExecutionQueueOptions options;
+    options.name = "metrics \"test\"";
+    options.tag = "tenant-1";
+    options.collectLatencyStats = true;
+    options.accountResourceUsage = true;
+    auto queue = execq::CreateConcurrentExecutionQueue<void, int>(pool, [] (const std::atomic_bool& isCanceled, int&& object) {}, options);
+    
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 10; i++)
+    {
+        futures.push_back(queue->push(i));
+    }
+    for (auto& future : futures)
+    {
+        future.wait();
+    }
+    
+    const std::string metrics = execq::GetPrometheusMetrics();
+    const std::string labels = "kind=\"concurrent_queue\",name=\"metrics \\\"test\\\"\",tag=\"tenant-1\"";
+    
+    EXPECT_NE(metrics.find("# TYPE execq_pool_workers gauge\n"), std::string::npos);
+    EXPECT_NE(metrics.find("# TYPE execq_pool_running_workers gauge\n"), std::string::npos);
+    EXPECT_NE(metrics.find("# TYPE execq_queue_completed_total counter\n"), std::string::npos);
+    EXPECT_NE(metrics.find("execq_queue_completed_total{" + labels), std::string::npos);
+    EXPECT_NE(metrics.find("execq_queue_pending{" + labels), std::string::npos);
+    EXPECT_NE(metrics.find("execq_queue_wait_seconds{" + labels), std::string::npos);
+    EXPECT_NE(metrics.find("execq_queue_execution_seconds_count{" + labels), std::string::npos);
+    EXPECT_NE(metrics.find("execq_queue_cpu_seconds_total{" + labels), std::string::npos);
+    
+    // Counter value follows the labels
+    const size_t completedPosition = metrics.find("execq_queue_completed_total{" + labels);
+    const size_t valuePosition = metrics.find("} ", completedPosition) + 2;
+    EXPECT_EQ(metrics.substr(valuePosition, metrics.find('\n', valuePosition) - valuePosition), "10");
+    
+    // Destroyed queue disappears from the metrics
+    queue.reset();
+    EXPECT_EQ(execq::GetPrometheusMetrics().find(labels), std::string::npos);
+}
+
+TEST(ExecutionPool, Metrics_WriteFile)
+{
+    auto queue = execq::CreateSerialExecutionQueue<void, int>([] (const std::atomic_bool& isCanceled, int&& object) {});
+    queue->push(0).wait();
+    
+    const std::string path = "execq_metrics_test.prom";
+    ASSERT_TRUE(execq::WritePrometheusMetrics(path));
+    
+    std::ifstream file(path);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_NE(content.str().find("execq_queue_completed_total{kind=\"serial_queue\",name=\"ExecutionQueue\""), std::string::npos);
+    
+    std::remove(path.c_str());
+    
+    EXPECT_FALSE(execq::WritePrometheusMetrics("/nonexistent-directory/metrics.prom"));
+}
@@ -0,0 +1,92 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ProfiledMutex.h"
+#include "execq.h"
+#include "ExecqTestUtil.h"
+
+#include <sstream>
+
+namespace
+{
+    const execq::LockSiteStats* FindSite(const std::vector<execq::LockSiteStats>& profile, const std::string& site)
+    {
+        for (const execq::LockSiteStats& stats : profile)
+        {
+            if (stats.site == site)
+            {
+                return &stats;
+            }
+        }
+        
+        return nullptr;
+    }
+}
+
+TEST(ExecutionPool, ProfiledMutex_Contention)
+{
+    execq::impl::ProfiledMutex mutex("ProfiledMutexTest::mutex");
+    execq::ResetLockProfile();
+    
+    // The second thread waits while the first holds the mutex
+    mutex.lock();
+    std::thread thread([&mutex] {
+        std::lock_guard<execq::impl::ProfiledMutex> lock(mutex);
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    mutex.unlock();
+    thread.join();
+    
+    const std::vector<execq::LockSiteStats> profile = execq::GetLockProfile();
+    const execq::LockSiteStats* stats = FindSite(profile, "ProfiledMutexTest::mutex");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_EQ(stats->acquisitions, 2);
+    EXPECT_EQ(stats->contendedAcquisitions, 1);
+    EXPECT_GE(stats->maxWaitTime, std::chrono::milliseconds(5));
+    EXPECT_GE(stats->maxHoldTime, std::chrono::milliseconds(10));
+    EXPECT_EQ(stats->totalWaitTime, stats->maxWaitTime);
+    
+    std::ostringstream dump;
+    execq::DumpLockProfile(dump);
+    EXPECT_NE(dump.str().find("ProfiledMutexTest::mutex"), std::string::npos);
+    
+    execq::ResetLockProfile();
+    EXPECT_EQ(FindSite(execq::GetLockProfile(), "ProfiledMutexTest::mutex")->acquisitions, 0);
+}
+
+#ifdef EXECQ_MUTEX_PROFILING
+TEST(ExecutionPool, ProfiledMutex_LockSites)
+{
+    execq::ResetLockProfile();
+    auto queue = execq::CreateSerialExecutionQueue<void, int>([] (const std::atomic_bool& isCanceled, int&& object) {});
+    queue->push(0).wait();
+    
+    // Queue mutexes are profiled when execq is built with EXECQ_MUTEX_PROFILING
+    const std::vector<execq::LockSiteStats> profile = execq::GetLockProfile();
+    const execq::LockSiteStats* stats = FindSite(profile, "ExecutionQueue::m_taskQueueMutex");
+    ASSERT_NE(stats, nullptr);
+    EXPECT_GT(stats->acquisitions, 0);
+}
+#endif
@@ -0,0 +1,190 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "execq.h"
+#include "ExecqTestUtil.h"
+
+namespace
+{
+    struct SimulationResult
+    {
+        std::vector<std::pair<int, std::chrono::nanoseconds>> finishTimes;
+        std::chrono::nanoseconds makespan { 0 };
+    };
+    
+    SimulationResult SimulateQueue(const bool serial, const uint32_t threadCount, const execq::SimulationOptions& simulationOptions)
+    {
+        SimulationResult result;
+        std::unique_ptr<execq::ISimulation> simulation = execq::CreateSimulation(simulationOptions);
+        
+        execq::ExecutionPoolOptions poolOptions;
+        poolOptions.threadCount = threadCount;
+        auto pool = execq::CreateSimulatedExecutionPool(*simulation, poolOptions);
+        
+        // Object 'i' costs 'i + 1' ms.
+        execq::ExecutionQueueOptions queueOptions;
+        queueOptions.serialBatchDuration = std::chrono::microseconds(0);
+        std::function<void(const std::atomic_bool&, int&&)> executor = [&] (const std::atomic_bool& isCanceled, int&& object) {
+            execq::ConsumeSimulatedTime(std::chrono::milliseconds(object + 1));
+            result.finishTimes.emplace_back(object, simulation->now());
+        };
+        auto queue = serial
+        ? execq::CreateSerialExecutionQueue<void, int>(pool, executor, queueOptions)
+        : execq::CreateConcurrentExecutionQueue<void, int>(pool, executor, queueOptions);
+        
+        simulation->schedule(std::chrono::nanoseconds(0), [&] {
+            for (int i = 0; i < 8; i++)
+            {
+                queue->push(i);
+            }
+        });
+        simulation->run();
+        result.makespan = simulation->now();
+        
+        return result;
+    }
+}
+
+TEST(ExecutionPool, Simulation_SerialQueue)
+{
+    const SimulationResult result = SimulateQueue(true, 4, execq::SimulationOptions());
+    
+    // Serial queue processes objects one by one regardless of number of workers: 1 + 2 + ... + 8 ms
+    ASSERT_EQ(result.finishTimes.size(), 8);
+    std::chrono::nanoseconds expectedTime { 0 };
+    for (int i = 0; i < 8; i++)
+    {
+        expectedTime += std::chrono::milliseconds(i + 1);
+        EXPECT_EQ(result.finishTimes[i].first, i);
+        EXPECT_EQ(result.finishTimes[i].second, expectedTime);
+    }
+    EXPECT_EQ(result.makespan, std::chrono::milliseconds(36));
+}
+
+TEST(ExecutionPool, Simulation_ConcurrentQueueIsDeterministic)
+{
+    const SimulationResult result = SimulateQueue(false, 2, execq::SimulationOptions());
+    ASSERT_EQ(result.finishTimes.size(), 8);
+    
+    // Objects are spread across 2 pool workers and the queue own worker
+    EXPECT_LT(result.makespan, std::chrono::milliseconds(36));
+    EXPECT_GE(result.makespan, std::chrono::milliseconds(12));
+    
+    // Repeated simulation gives exactly the same schedule
+    for (int i = 0; i < 5; i++)
+    {
+        const SimulationResult repeated = SimulateQueue(false, 2, execq::SimulationOptions());
+        EXPECT_EQ(repeated.finishTimes, result.finishTimes);
+        EXPECT_EQ(repeated.makespan, result.makespan);
+    }
+    
+    // Costs of the scheduler itself are accounted too
+    execq::SimulationOptions expensiveOptions;
+    expensiveOptions.taskOverhead = std::chrono::milliseconds(1);
+    expensiveOptions.wakeupLatency = std::chrono::milliseconds(1);
+    EXPECT_GT(SimulateQueue(false, 2, expensiveOptions).makespan, result.makespan);
+}
+
+TEST(ExecutionPool, Simulation_WorkerStats)
+{
+    std::unique_ptr<execq::ISimulation> simulation = execq::CreateSimulation();
+    
+    execq::ExecutionPoolOptions poolOptions;
+    poolOptions.threadCount = 1;
+    auto pool = execq::CreateSimulatedExecutionPool(*simulation, poolOptions);
+    auto queue = execq::CreateSerialExecutionQueue<void, int>(pool, [] (const std::atomic_bool& isCanceled, int&& object) {
+        execq::ConsumeSimulatedTime(std::chrono::milliseconds(5));
+    });
+    
+    simulation->schedule(std::chrono::milliseconds(10), [&] {
+        queue->push(0);
+    });
+    simulation->run();
+    
+    EXPECT_EQ(simulation->now(), std::chrono::milliseconds(15));
+    
+    // Pool worker and the queue own worker
+    const std::vector<execq::SimulatedWorkerStats> stats = simulation->workerStats();
+    ASSERT_EQ(stats.size(), 2);
+    EXPECT_EQ(stats[0].wakeups + stats[1].wakeups, 1);
+    EXPECT_EQ(stats[0].tasksExecuted + stats[1].tasksExecuted, 1);
+    EXPECT_EQ(stats[0].busyTime + stats[1].busyTime, std::chrono::milliseconds(5));
+}
+
+TEST(ExecutionPool, Simulation_LocalTasksAreDeterministic)
+{
+    // Objects pushed from the pool thread go to its local queue. Without real-clock steal timer the schedule depends on virtual time only.
+    const auto simulate = [] {
+        std::unique_ptr<execq::ISimulation> simulation = execq::CreateSimulation();
+        
+        execq::ExecutionPoolOptions poolOptions;
+        poolOptions.threadCount = 2;
+        auto pool = execq::CreateSimulatedExecutionPool(*simulation, poolOptions);
+        
+        std::vector<std::pair<int, std::chrono::nanoseconds>> finishTimes;
+        std::unique_ptr<execq::IExecutionQueue<void(int)>> queue;
+        queue = execq::CreateConcurrentExecutionQueue<void, int>(pool, [&] (const std::atomic_bool& isCanceled, int&& object) {
+            if (object < 4)
+            {
+                queue->push(object + 4);
+            }
+            execq::ConsumeSimulatedTime(std::chrono::milliseconds(object + 1));
+            finishTimes.emplace_back(object, simulation->now());
+        });
+        
+        simulation->schedule(std::chrono::nanoseconds(0), [&] {
+            for (int i = 0; i < 4; i++)
+            {
+                queue->push(i);
+            }
+        });
+        simulation->run();
+        
+        return finishTimes;
+    };
+    
+    const std::vector<std::pair<int, std::chrono::nanoseconds>> finishTimes = simulate();
+    EXPECT_EQ(finishTimes.size(), 8);
+    for (int i = 0; i < 5; i++)
+    {
+        EXPECT_EQ(simulate(), finishTimes);
+    }
+}
+
+TEST(ExecutionPool, Simulation_ForeignSimulation)
+{
+    class Simulation: public execq::ISimulation
+    {
+    public:
+        virtual void schedule(const std::chrono::nanoseconds time, std::function<void()> event) override {}
+        virtual void run() override {}
+        virtual std::chrono::nanoseconds now() const override { return std::chrono::nanoseconds(0); }
+        virtual std::vector<execq::SimulatedWorkerStats> workerStats() const override { return {}; }
+    };
+    
+    Simulation simulation;
+    EXPECT_THROW(execq::CreateSimulatedExecutionPool(simulation), std::runtime_error);
+}
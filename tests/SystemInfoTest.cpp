@@ -0,0 +1,75 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "SystemInfo.h"
+#include "execq.h"
+
+#include <thread>
+
+#include <gmock/gmock.h>
+
+TEST(ExecutionPool, SystemInfo_ParseCpuList)
+{
+    using execq::impl::ParseCpuList;
+    
+    EXPECT_EQ(ParseCpuList("0"), std::vector<uint32_t>({ 0 }));
+    EXPECT_EQ(ParseCpuList("0-3"), std::vector<uint32_t>({ 0, 1, 2, 3 }));
+    EXPECT_EQ(ParseCpuList("0-1,8,10-11\n"), std::vector<uint32_t>({ 0, 1, 8, 10, 11 }));
+    EXPECT_EQ(ParseCpuList("4,0-1,1"), std::vector<uint32_t>({ 0, 1, 4 }));
+    EXPECT_EQ(ParseCpuList("0,2-3"), std::vector<uint32_t>({ 0, 2, 3 })); // sparse NUMA node list
+    EXPECT_TRUE(ParseCpuList("").empty());
+    
+    // Malformed lists are rejected at whole
+    EXPECT_TRUE(ParseCpuList("0-").empty());
+    EXPECT_TRUE(ParseCpuList("3-1").empty());
+    EXPECT_TRUE(ParseCpuList("0,a").empty());
+}
+
+TEST(ExecutionPool, SystemInfo_ParseCgroupCpuQuota)
+{
+    using execq::impl::ParseCgroupV2CpuMax;
+    using execq::impl::ParseCgroupV1CpuQuota;
+    
+    EXPECT_DOUBLE_EQ(ParseCgroupV2CpuMax("400000 100000\n"), 4);
+    EXPECT_DOUBLE_EQ(ParseCgroupV2CpuMax("150000 100000"), 1.5);
+    EXPECT_DOUBLE_EQ(ParseCgroupV2CpuMax("max 100000"), 0);
+    EXPECT_DOUBLE_EQ(ParseCgroupV2CpuMax(""), 0);
+    
+    EXPECT_DOUBLE_EQ(ParseCgroupV1CpuQuota("200000", "100000"), 2);
+    EXPECT_DOUBLE_EQ(ParseCgroupV1CpuQuota("-1", "100000"), 0);
+    EXPECT_DOUBLE_EQ(ParseCgroupV1CpuQuota("100000", "0"), 0);
+}
+
+TEST(ExecutionPool, SystemInfo_OptimalThreadCount)
+{
+    const uint32_t threadCount = execq::GetOptimalThreadCount();
+    EXPECT_GE(threadCount, 1);
+    
+    const uint32_t hardwareThreadCount = std::thread::hardware_concurrency();
+    if (hardwareThreadCount)
+    {
+        EXPECT_LE(threadCount, hardwareThreadCount);
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "execq.h"
+#include "TaskGroup.h"
+#include "ExecqTestUtil.h"
+
+using namespace execq::test;
+
+TEST(ExecutionPool, TaskGroup_RunAndWait)
+{
+    auto pool = execq::CreateExecutionPool();
+    auto group = execq::CreateTaskGroup(pool);
+    
+    std::atomic_size_t executedCount { 0 };
+    const size_t count = 1000;
+    for (size_t i = 0; i < count; i++)
+    {
+        group->run([&executedCount] (const std::atomic_bool& isCanceled) {
+            executedCount++;
+        });
+    }
+    
+    EXPECT_TRUE(group->wait().empty());
+    EXPECT_EQ(executedCount.load(), count);
+}
+
+TEST(ExecutionPool, TaskGroup_Exceptions)
+{
+    auto pool = execq::CreateExecutionPool();
+    auto group = execq::CreateTaskGroup(pool);
+    
+    group->run([] (const std::atomic_bool& isCanceled) {
+        throw std::runtime_error("first");
+    });
+    group->run([] (const std::atomic_bool& isCanceled) {});
+    group->run([] (const std::atomic_bool& isCanceled) {
+        throw std::runtime_error("second");
+    });
+    
+    // All exceptions are gathered and returned once
+    EXPECT_EQ(group->wait().size(), 2);
+    EXPECT_TRUE(group->wait().empty());
+}
+
+TEST(ExecutionPool, TaskGroup_Cancelability)
+{
+    auto executionPool = std::make_shared<MockExecutionPool>();
+    
+    // Group has no own thread, so it executes tasks when waited
+    execq::impl::ITaskProvider* registeredProvider = nullptr;
+    EXPECT_CALL(*executionPool, addProvider(SaveArgAddress(&registeredProvider)))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(*executionPool, notifyOneWorker())
+    .WillRepeatedly(::testing::Return(false));
+    EXPECT_CALL(*executionPool, executeNextTask())
+    .WillRepeatedly(::testing::Return(false));
+    
+    execq::impl::TaskGroup group(executionPool);
+    ASSERT_NE(registeredProvider, nullptr);
+    
+    ::testing::MockFunction<void(const std::atomic_bool&)> mockTask;
+    
+    // Only tasks added before 'cancel' call are really canceled
+    group.run(mockTask.AsStdFunction());
+    group.cancel();
+    group.run(mockTask.AsStdFunction());
+    
+    ::testing::InSequence sequence;
+    EXPECT_CALL(mockTask, Call(CompareWithAtomic(true)))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(mockTask, Call(CompareWithAtomic(false)))
+    .WillOnce(::testing::Return());
+    
+    // First task is executed by the pool, second one is executed while waiting
+    execq::impl::Task task = registeredProvider->nextTask();
+    ASSERT_TRUE(task.valid());
+    task();
+    
+    group.wait();
+    EXPECT_FALSE(registeredProvider->nextTask().valid());
+    
+    
+    //  Group must 'unregister' itself in ExecutionPool when destroyed
+    EXPECT_CALL(*executionPool, removeProvider(::testing::_))
+    .WillOnce(::testing::Return());
+}
+
+TEST(ExecutionPool, TaskGroup_WaitOnNonPoolThread)
+{
+    auto executionPool = std::make_shared<MockExecutionPool>();
+    
+    EXPECT_CALL(*executionPool, addProvider(::testing::_))
+    .WillOnce(::testing::Return());
+    EXPECT_CALL(*executionPool, notifyOneWorker())
+    .WillRepeatedly(::testing::Return(false));
+    EXPECT_CALL(*executionPool, removeProvider(::testing::_))
+    .WillOnce(::testing::Return());
+    
+    // Thread that does not belong to the pool must not execute foreign pool tasks while waiting
+    EXPECT_CALL(*executionPool, executeNextTask())
+    .Times(0);
+    
+    execq::impl::TaskGroup group(executionPool);
+    
+    ::testing::MockFunction<void(const std::atomic_bool&)> mockTask;
+    EXPECT_CALL(mockTask, Call(CompareWithAtomic(false)))
+    .WillOnce(::testing::Return());
+    
+    group.run(mockTask.AsStdFunction());
+    EXPECT_TRUE(group.wait().empty());
+}
+
+TEST(ExecutionPool, TaskGroup_NullPool)
+{
+    EXPECT_THROW(execq::CreateTaskGroup(nullptr), std::runtime_error);
+}
@@ -44,6 +44,24 @@ namespace
     {
         return execq::impl::Task();
     }
+    
+    class RemovalCheckingTaskProvider: public execq::impl::ITaskProvider
+    {
+    public:
+        virtual execq::impl::Task nextTask() final
+        {
+            if (removed)
+            {
+                calledAfterRemoval = true;
+            }
+            
+            return execq::impl::Task();
+        }
+        
+    public:
+        std::atomic_bool removed { false };
+        std::atomic_bool calledAfterRemoval { false };
+    };
 }
 
 TEST(ExecutionPool, TaskProviderList_NoItems)
@@ -136,6 +154,94 @@ TEST(ExecutionPool, TaskProviderList_Add_Remove)
     EXPECT_FALSE(providers.nextTask().valid());
 }
 
+TEST(ExecutionPool, TaskProviderList_EarliestDeadlineFirst)
+{
+    const bool earliestDeadlineFirst = true;
+    execq::impl::TaskProviderList providers(earliestDeadlineFirst);
+    
+    // fill group with providers
+    MockTaskProvider provider1;
+    providers.addProvider(provider1);
+    
+    MockTaskProvider provider2;
+    providers.addProvider(provider2);
+    
+    MockTaskProvider provider3;
+    providers.addProvider(provider3);
+    
+    // Provider #3 has the most urgent task, provider #2 is next. Provider #1 has no deadlines
+    const auto now = std::chrono::steady_clock::now();
+    providers.setProviderDeadline(provider2, now + std::chrono::seconds(2));
+    providers.setProviderDeadline(provider3, now + std::chrono::seconds(1));
+    
+    {
+        InSequence sequence;
+        EXPECT_CALL(provider3, nextTask())
+        .WillOnce([] { return MakeValidTask(); });
+        
+        // Provider #3 is busy now, so the next urgent is #2
+        EXPECT_CALL(provider3, nextTask())
+        .WillOnce([] { return MakeInvalidTask(); });
+        EXPECT_CALL(provider2, nextTask())
+        .WillOnce([] { return MakeValidTask(); });
+    }
+    
+    EXPECT_TRUE(providers.nextTask().valid());
+    EXPECT_TRUE(providers.nextTask().valid());
+    
+    
+    // When providers have no more deadlines, they are served 'by turn'
+    providers.setProviderDeadline(provider2, std::chrono::steady_clock::time_point::max());
+    providers.setProviderDeadline(provider3, std::chrono::steady_clock::time_point::max());
+    
+    EXPECT_CALL(provider1, nextTask())
+    .WillOnce([] { return MakeValidTask(); });
+    
+    EXPECT_TRUE(providers.nextTask().valid());
+}
+
+TEST(ExecutionPool, TaskProviderList_ConcurrentAddRemove)
+{
+    execq::impl::TaskProviderList providers;
+    
+    RemovalCheckingTaskProvider permanentProvider;
+    providers.addProvider(permanentProvider);
+    
+    std::atomic_bool stop { false };
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < 4; i++)
+    {
+        readers.emplace_back([&] {
+            while (!stop)
+            {
+                providers.nextTask();
+            }
+        });
+    }
+    
+    // Removed provider must never be touched after 'removeProvider' returns
+    RemovalCheckingTaskProvider transientProviders[8];
+    for (size_t i = 0; i < 1000; i++)
+    {
+        RemovalCheckingTaskProvider& provider = transientProviders[i % 8];
+        provider.removed = false;
+        providers.addProvider(provider);
+        providers.removeProvider(provider);
+        provider.removed = true;
+    }
+    
+    stop = true;
+    for (auto& reader : readers)
+    {
+        reader.join();
+    }
+    
+    for (const auto& provider : transientProviders)
+    {
+        EXPECT_FALSE(provider.calledAfterRemoval);
+    }
+}
+
 TEST(ExecutionPool, ThreadWorkerPool_NotifyWorkers_Single)
 {
     using namespace execq::impl;
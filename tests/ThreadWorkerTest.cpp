@@ -0,0 +1,174 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "ThreadWorker.h"
+#include "ExecqTestUtil.h"
+
+#include <string>
+
+#if defined(__linux__)
+#include <pthread.h>
+#endif
+
+using namespace execq::test;
+
+namespace
+{
+    class CountingTaskProvider: public execq::impl::ITaskProvider
+    {
+    public:
+        virtual execq::impl::Task nextTask() final
+        {
+            // Each new thread has its own copy of thread-local flag
+            static thread_local bool s_firstCall = true;
+            if (s_firstCall)
+            {
+                s_firstCall = false;
+                threadStartCount++;
+            }
+            
+            if (!pendingCount)
+            {
+                return execq::impl::Task();
+            }
+            
+            pendingCount--;
+            return execq::impl::Task([this] {
+                executedCount++;
+            });
+        }
+        
+    public:
+        std::atomic_size_t pendingCount { 0 };
+        std::atomic_size_t executedCount { 0 };
+        std::atomic_size_t threadStartCount { 0 };
+    };
+}
+
+TEST(ExecutionPool, ThreadWorker_IdleTimeout)
+{
+    CountingTaskProvider provider;
+    
+    execq::impl::ThreadWorkerOptions options;
+    options.idleTimeout = std::chrono::milliseconds(10);
+    auto worker = execq::impl::IThreadWorkerFactory::defaultFactory()->createWorker(provider, options);
+    
+    // Thread is started lazily on the first notification
+    provider.pendingCount++;
+    EXPECT_TRUE(worker->notifyWorker());
+    WaitForLongTermJob();
+    EXPECT_EQ(provider.executedCount.load(), 1);
+    EXPECT_EQ(provider.threadStartCount.load(), 1);
+    
+    // Idle thread has exited, so new one is started on the next notification
+    provider.pendingCount++;
+    EXPECT_TRUE(worker->notifyWorker());
+    WaitForLongTermJob();
+    EXPECT_EQ(provider.executedCount.load(), 2);
+    EXPECT_EQ(provider.threadStartCount.load(), 2);
+}
+
+TEST(ExecutionPool, ThreadWorker_StartEagerly)
+{
+    CountingTaskProvider provider;
+    
+    execq::impl::ThreadWorkerOptions options;
+    options.startEagerly = true;
+    options.prefaultStackSize = 64 * 1024;
+    auto worker = execq::impl::IThreadWorkerFactory::defaultFactory()->createWorker(provider, options);
+    
+    // Eagerly started thread parks without checking for tasks
+    WaitForLongTermJob();
+    EXPECT_EQ(provider.threadStartCount.load(), 0);
+    
+    provider.pendingCount++;
+    EXPECT_TRUE(worker->notifyWorker());
+    WaitForLongTermJob();
+    EXPECT_EQ(provider.executedCount.load(), 1);
+    EXPECT_EQ(provider.threadStartCount.load(), 1);
+}
+
+TEST(ExecutionPool, ThreadWorker_ThreadOptions)
+{
+    CountingTaskProvider provider;
+    
+    std::atomic_size_t startHookCount { 0 };
+    std::atomic_bool nameMatches { false };
+    
+    execq::impl::ThreadWorkerOptions options;
+    options.threadOptions.name = "execq-test-worker";
+    options.threadOptions.stackSize = 256 * 1024;
+    options.threadOptions.onThreadStart = [&] {
+        startHookCount++;
+#if defined(__linux__)
+        char name[16] = {};
+        pthread_getname_np(pthread_self(), name, sizeof(name));
+        nameMatches = std::string(name) == "execq-test-work";
+#else
+        nameMatches = true;
+#endif
+    };
+    auto worker = execq::impl::IThreadWorkerFactory::defaultFactory()->createWorker(provider, options);
+    
+    // Hook is called on the worker thread before it takes any task
+    provider.pendingCount++;
+    EXPECT_TRUE(worker->notifyWorker());
+    WaitForLongTermJob();
+    EXPECT_EQ(provider.executedCount.load(), 1);
+    EXPECT_EQ(startHookCount.load(), 1);
+    EXPECT_TRUE(nameMatches);
+}
+
+TEST(ExecutionPool, ThreadWorker_NoLostWakeups)
+{
+    const size_t iterationCount = 20000;
+    const std::chrono::milliseconds idleTimeouts[] = { std::chrono::milliseconds(0), std::chrono::milliseconds(1) };
+    for (const std::chrono::milliseconds idleTimeout : idleTimeouts)
+    {
+        CountingTaskProvider provider;
+        
+        execq::impl::ThreadWorkerOptions options;
+        options.idleTimeout = idleTimeout;
+        auto worker = execq::impl::IThreadWorkerFactory::defaultFactory()->createWorker(provider, options);
+        
+        // Notifications race with the worker going to park (and exiting because of idle timeout)
+        for (size_t i = 0; i < iterationCount; i++)
+        {
+            provider.pendingCount++;
+            worker->notifyWorker();
+            if (i % 64 == 0)
+            {
+                std::this_thread::sleep_for(std::chrono::microseconds(i % 1500));
+            }
+        }
+        
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (provider.executedCount < iterationCount && std::chrono::steady_clock::now() < deadline)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        EXPECT_EQ(provider.executedCount.load(), iterationCount);
+    }
+}
@@ -0,0 +1,139 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "TimerWheel.h"
+#include "ExecqTestUtil.h"
+
+using namespace execq::test;
+
+namespace
+{
+    const std::chrono::milliseconds kResolution { 1 };
+    const size_t kSlotCount = 16;
+}
+
+TEST(ExecutionPool, TimerWheel_FiresInOrder)
+{
+    execq::impl::TimerWheel wheel(kResolution, kSlotCount);
+    
+    std::mutex mutex;
+    std::vector<int> fired;
+    std::promise<void> lastFired;
+    
+    // Delays exceed one revolution of the wheel, so some timers wait for their round
+    const auto now = execq::impl::TimerWheel::Clock::now();
+    wheel.schedule(now + std::chrono::milliseconds(40), [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        fired.push_back(3);
+        lastFired.set_value();
+    });
+    wheel.schedule(now + std::chrono::milliseconds(5), [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        fired.push_back(1);
+    });
+    wheel.schedule(now + std::chrono::milliseconds(21), [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        fired.push_back(2);
+    });
+    
+    ASSERT_TRUE(lastFired.get_future().wait_for(kTimeout) == std::future_status::ready);
+    EXPECT_GE(execq::impl::TimerWheel::Clock::now() - now, std::chrono::milliseconds(40));
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(fired, std::vector<int>({ 1, 2, 3 }));
+}
+
+TEST(ExecutionPool, TimerWheel_Cancel)
+{
+    execq::impl::TimerWheel wheel(kResolution, kSlotCount);
+    
+    ::testing::MockFunction<void()> mockCallback;
+    EXPECT_CALL(mockCallback, Call())
+    .Times(0);
+    
+    auto timer = wheel.schedule(execq::impl::TimerWheel::Clock::now() + kLongTermJob, mockCallback.AsStdFunction());
+    
+    // Only the first cancel is successful
+    EXPECT_TRUE(wheel.cancel(timer));
+    EXPECT_FALSE(wheel.cancel(timer));
+    
+    WaitForLongTermJob();
+    WaitForLongTermJob();
+}
+
+TEST(ExecutionPool, TimerWheel_ManyTimers)
+{
+    execq::impl::TimerWheel wheel(kResolution, kSlotCount);
+    
+    const size_t count = 100000;
+    std::atomic_size_t firedCount { 0 };
+    std::vector<execq::impl::TimerWheel::TimerHandle> timers;
+    
+    const auto now = execq::impl::TimerWheel::Clock::now();
+    for (size_t i = 0; i < count; i++)
+    {
+        timers.push_back(wheel.schedule(now + std::chrono::milliseconds(i % 50), [&firedCount] {
+            firedCount++;
+        }));
+    }
+    
+    // Cancel each second timer
+    size_t canceledCount = 0;
+    for (size_t i = 0; i < count; i += 2)
+    {
+        canceledCount += wheel.cancel(timers[i]);
+    }
+    
+    WaitForLongTermJob();
+    
+    EXPECT_EQ(firedCount + canceledCount, count);
+}
+
+TEST(ExecutionPool, TimerWheel_SparseSlots)
+{
+    // Slot count is not a multiple of the bitmap word, and timers are far apart
+    execq::impl::TimerWheel wheel(kResolution, 100);
+    
+    std::mutex mutex;
+    std::vector<int> fired;
+    std::promise<void> lastFired;
+    
+    const auto now = execq::impl::TimerWheel::Clock::now();
+    wheel.schedule(now + std::chrono::milliseconds(130), [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        fired.push_back(2);
+        lastFired.set_value();
+    });
+    wheel.schedule(now + std::chrono::milliseconds(70), [&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        fired.push_back(1);
+    });
+    
+    ASSERT_TRUE(lastFired.get_future().wait_for(kTimeout) == std::future_status::ready);
+    EXPECT_GE(execq::impl::TimerWheel::Clock::now() - now, std::chrono::milliseconds(130));
+    
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(fired, std::vector<int>({ 1, 2 }));
+}
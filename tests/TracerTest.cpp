@@ -0,0 +1,100 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include "execq.h"
+#include "ExecqTestUtil.h"
+
+#include <sstream>
+
+namespace
+{
+    size_t CountOccurrences(const std::string& string, const std::string& substring)
+    {
+        size_t count = 0;
+        for (size_t position = string.find(substring); position != std::string::npos; position = string.find(substring, position + 1))
+        {
+            count++;
+        }
+        
+        return count;
+    }
+    
+    void ProcessObjects(execq::IExecutionQueue<void(int)>& queue, const int count)
+    {
+        std::vector<std::future<void>> futures;
+        for (int i = 0; i < count; i++)
+        {
+            futures.push_back(queue.push(i));
+        }
+        for (auto& future : futures)
+        {
+            future.wait();
+        }
+    }
+}
+
+TEST(ExecutionPool, Tracing_ChromeTrace)
+{
+    execq::ExecutionQueueOptions options;
+    options.name = "trace-queue";
+    options.threadOptions.name = "trace-thread";
+    auto queue = execq::CreateSerialExecutionQueue<void, int>([] (const std::atomic_bool& isCanceled, int&& object) {}, options);
+    
+    // Nothing is recorded before tracing is started
+    ProcessObjects(*queue, 1);
+    
+    execq::StartTracing();
+    ProcessObjects(*queue, 3);
+    execq::StopTracing();
+    
+    ProcessObjects(*queue, 1);
+    
+    std::ostringstream trace;
+    execq::ExportChromeTrace(trace);
+    const std::string json = trace.str();
+    
+    EXPECT_EQ(json.find(R"({"displayTimeUnit":"ns","traceEvents":[)"), 0);
+    EXPECT_EQ(CountOccurrences(json, R"({"name":"trace-queue","cat":"execq","ph":"B")"), 3);
+    EXPECT_EQ(CountOccurrences(json, R"({"name":"trace-queue","cat":"execq","ph":"E")"), 3);
+    EXPECT_EQ(CountOccurrences(json, R"("args":{"name":"trace-thread"})"), 1);
+}
+
+TEST(ExecutionPool, Tracing_RingBufferOverflow)
+{
+    execq::ExecutionQueueOptions options;
+    options.name = "trace-ring-queue";
+    auto queue = execq::CreateSerialExecutionQueue<void, int>([] (const std::atomic_bool& isCanceled, int&& object) {}, options);
+    
+    // Only the latest events fit the buffer of the queue thread
+    const size_t eventsPerThread = 4;
+    execq::StartTracing(eventsPerThread);
+    ProcessObjects(*queue, 10);
+    execq::StopTracing();
+    
+    std::ostringstream trace;
+    execq::ExportChromeTrace(trace);
+    EXPECT_LE(CountOccurrences(trace.str(), R"("name":"trace-ring-queue")"), eventsPerThread);
+    EXPECT_GE(CountOccurrences(trace.str(), R"("name":"trace-ring-queue")"), 1);
+}
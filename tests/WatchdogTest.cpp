@@ -0,0 +1,99 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2018 Alkenso (Vladimir Vashurkin)
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+#include "execq.h"
+#include "ExecqTestUtil.h"
+
+#include <mutex>
+
+TEST(ExecutionPool, Watchdog_LongRunningTask)
+{
+    std::mutex reportsMutex;
+    std::vector<execq::LongRunningTask> reports;
+    
+    execq::WatchdogOptions options;
+    options.checkInterval = std::chrono::milliseconds(5);
+    options.longTaskThreshold = std::chrono::milliseconds(30);
+    options.onLongRunningTask = [&] (const execq::LongRunningTask& task) {
+        std::lock_guard<std::mutex> lock(reportsMutex);
+        reports.push_back(task);
+    };
+    execq::StartWatchdog(options);
+    
+    execq::ExecutionQueueOptions queueOptions;
+    queueOptions.name = "hung";
+    auto queue = execq::CreateSerialExecutionQueue<void, std::chrono::milliseconds>([] (const std::atomic_bool& isCanceled, std::chrono::milliseconds&& duration) {
+        std::this_thread::sleep_for(duration);
+    }, queueOptions);
+    
+    queue->push(std::chrono::milliseconds(1)).wait();
+    queue->push(std::chrono::milliseconds(150)).wait();
+    
+    execq::StopWatchdog();
+    
+    // Long task is reported once, short one is not reported
+    std::lock_guard<std::mutex> lock(reportsMutex);
+    ASSERT_EQ(reports.size(), 1);
+    EXPECT_EQ(reports[0].name, "hung");
+    EXPECT_GE(reports[0].duration, std::chrono::milliseconds(30));
+    EXPECT_LT(reports[0].duration, std::chrono::milliseconds(150));
+}
+
+TEST(ExecutionPool, Watchdog_StarvedQueue)
+{
+    std::mutex reportsMutex;
+    std::vector<execq::StarvedQueue> reports;
+    
+    execq::WatchdogOptions options;
+    options.checkInterval = std::chrono::milliseconds(5);
+    options.starvationThreshold = std::chrono::milliseconds(30);
+    options.onStarvedQueue = [&] (const execq::StarvedQueue& queue) {
+        std::lock_guard<std::mutex> lock(reportsMutex);
+        reports.push_back(queue);
+    };
+    execq::StartWatchdog(options);
+    
+    execq::ExecutionQueueOptions queueOptions;
+    queueOptions.name = "starved";
+    queueOptions.tag = "tenant-1";
+    auto queue = execq::CreateSerialExecutionQueue<void, std::chrono::milliseconds>([] (const std::atomic_bool& isCanceled, std::chrono::milliseconds&& duration) {
+        std::this_thread::sleep_for(duration);
+    }, queueOptions);
+    
+    // The second object waits for the first one much longer than the threshold
+    std::future<void> first = queue->push(std::chrono::milliseconds(150));
+    std::future<void> second = queue->push(std::chrono::milliseconds(0));
+    second.wait();
+    
+    execq::StopWatchdog();
+    
+    std::lock_guard<std::mutex> lock(reportsMutex);
+    ASSERT_EQ(reports.size(), 1);
+    EXPECT_EQ(reports[0].name, "starved");
+    EXPECT_EQ(reports[0].tag, "tenant-1");
+    EXPECT_EQ(reports[0].pendingCount, 1);
+    EXPECT_GE(reports[0].starvedFor, std::chrono::milliseconds(30));
+}